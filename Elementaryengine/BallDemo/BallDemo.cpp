@@ -35,6 +35,10 @@ int main()
 		game.gameMode = mode;
 		game.Start();
 	}
+	else if (a == 2) {
+		// headless broadphase comparison on scaled up versions of the ball demo scene
+		EPhysicsBenchmark::Run();
+	}
 	else {
 		Game game = Game::Instance();
 		game.renderer = new ERasterizer();
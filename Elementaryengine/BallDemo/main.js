@@ -197,13 +197,17 @@ function placeBlock(){
             normal.scale(0.5);
             var ap = hitAsset.getPosition()
             normal.add(ap);
-            placedAsset = new Asset(normal,new Vec3(0.25,0.25,0.25),0); 
         }else{
             // Place the new asset on the surface of the hit asset at our hit position
             normal.scale(0.25);
             normal.add(hitPos);
-            placedAsset = new Asset(normal,new Vec3(0.25,0.25,0.25),0); 
         }
+
+        // Only place the block if its space is free. The box is a bit smaller than the block so touching neighbours don't count
+        if(game.overlapBox(normal,new Vec3(0.2,0.2,0.2)).length > 0){
+            return;
+        }
+        placedAsset = new Asset(normal,new Vec3(0.25,0.25,0.25),0); 
         // Attach the cube mesh to the asset
         m.attachto(placedAsset);
         // Add the asset to the list of placed assets
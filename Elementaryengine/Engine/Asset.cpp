@@ -1,6 +1,11 @@
 #include "Asset.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include "Game.h"
+#include <Model.h>
+#include <ECollisionEvents.h>
+#include <ETriggerVolume.h>
+#include <EContinuousCollision.h>
+#include <EPhysicsBake.h>
 #include <BulletCollision\CollisionShapes\btHeightfieldTerrainShape.h>
 
 const unsigned int Asset::ENVIRONMENT_WIDTH = 1024, Asset::ENVIRONMENT_HEIGHT = 1024;
@@ -27,23 +32,64 @@ Asset::Asset(vec3 pos, vec3 scale, int mass, assetShapes shape)
 	this->scale = scale;
 	position = pos;
 	assetShape = shape;
-	if (assetShape == assetShapes::ball) {
-		btAssetShape = new btSphereShape(scale.x);
-	}
-	else {
-		btAssetShape = new btBoxShape(btVector3(scale.x * collisionSizeOffset.x,scale.y* collisionSizeOffset.y,scale.z* collisionSizeOffset.z));
-	}
+	createRigidBody(mass);
+
+	rendererAssetCreatedCallback(this);
+}
+
+Asset::Asset(vec3 pos, vec3 scale, int mass, Model * collisionModel)
+{
+	Game::nextAssets.push_back(this);
+	OnTick = &defaultOnTick;
+
+	this->scale = scale;
+	position = pos;
+	assetShape = assetShapes::convexHulls;
+	this->collisionModel = collisionModel;
+	createRigidBody(mass);
+
+	rendererAssetCreatedCallback(this);
+}
+
+void Asset::createRigidBody(int mass)
+{
+	EPhysicsBake::Next(this);
+	btAssetShape = createCollisionShape();
 	btVector3 inertia(1, 1, 1);
 	q = glm::quat(vec3(0,0,0));
 	btAssetShape->calculateLocalInertia(mass, inertia);
-	assetMotionState = new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), btVector3(position.x + collisionPosOffset.x, position.y + collisionPosOffset.y, position.z + collisionPosOffset.z)));
+	assetMotionState = new EMotionState(this, btTransform(btQuaternion(0, 0, 0, 1), btVector3(position.x + collisionPosOffset.x, position.y + collisionPosOffset.y, position.z + collisionPosOffset.z)));
 	btRigidBody::btRigidBodyConstructionInfo groundRigidBodyCI(mass, assetMotionState, btAssetShape, inertia);
 	assetRigidBody = new btRigidBody(groundRigidBodyCI);
-	Game::dynamicsWorld->addRigidBody(assetRigidBody);
+	assetRigidBody->setUserPointer(this);
 	assetRigidBody->setFriction(1);
 	assetRigidBody->setRestitution(0);
+	// a baked body brings its transform, mass and flags
+	EPhysicsBake::Restore(this);
+	if (assetRigidBody->getInvMass() == 0 && collisionLayer == ECollisionLayers::defaultLayer)
+		collisionLayer = ECollisionLayers::staticLayer;
+	lock_guard<mutex> lock(Game::physicsMutex);
+	Game::dynamicsWorld->addRigidBody(assetRigidBody, ECollisionLayers::Group(collisionLayer), ECollisionLayers::Mask(collisionLayer));
+	updateCcd();
+}
 
-	rendererAssetCreatedCallback(this);
+btCollisionShape * Asset::createCollisionShape()
+{
+	// a loaded physics bake already has the shape
+	btCollisionShape* baked = EPhysicsBake::Shape(this);
+	if (baked != nullptr)
+		return baked;
+	vec3 size = scale * collisionSizeOffset;
+	if (assetShape == assetShapes::ball) {
+		return new btSphereShape(size.x);
+	}
+	if (assetShape == assetShapes::convexHulls && collisionModel != nullptr) {
+		// hull compounds are owned and shared by the model
+		btCompoundShape* compound = collisionModel->getCollisionShape(size);
+		if (compound != nullptr)
+			return compound;
+	}
+	return new btBoxShape(btVector3(size.x, size.y, size.z));
 }
 
 
@@ -60,13 +106,9 @@ DllExport void Asset::setScale(vec3 sca)
 {
 	scale = sca;
 	if (assetRigidBody != nullptr) {
-		if (assetShape == assetShapes::ball) {
-			btAssetShape = new btSphereShape(scale.x * collisionSizeOffset.x);
-		}
-		else {
-			btAssetShape = new btBoxShape(btVector3(scale.x * collisionSizeOffset.x, scale.y * collisionSizeOffset.y, scale.z* collisionSizeOffset.z));
-		}
+		btAssetShape = createCollisionShape();
 		assetRigidBody->setCollisionShape(btAssetShape);
+		updateCcd();
 	}
 
 	rendererAssetChangedCallback(this);
@@ -160,26 +202,27 @@ DllExport btRigidBody * Asset::getRigidBody()
 	return assetRigidBody;
 }
 
-// called every frame for game logic
-void Asset::Tick(GLFWwindow * window, double deltaTime)
+DllExport void Asset::setCollisionLayer(int layer)
 {
-	if (assetRigidBody != nullptr && Game::simulatePhysics) {
-		btTransform trans;
-		assetRigidBody->getMotionState()->getWorldTransform(trans);
-		if (Game::toGlm(trans.getOrigin()) != position ||
-			q.w != trans.getRotation().getW() || q.x != trans.getRotation().getX() || q.y != trans.getRotation().getY() || q.z != trans.getRotation().getZ())
-			rendererAssetChangedCallback(this);
-
-		position.x = trans.getOrigin().getX() - collisionPosOffset.x;
-		position.y = trans.getOrigin().getY() - collisionPosOffset.y;
-		position.z = trans.getOrigin().getZ() - collisionPosOffset.z;
+	if (layer < 0 || layer >= ECollisionLayers::maxLayers)
+		return;
+	collisionLayer = layer;
+	if (assetRigidBody != nullptr) {
+		lock_guard<mutex> lock(Game::physicsMutex);
+		// the filter is only read when the body enters the broadphase
+		Game::dynamicsWorld->removeRigidBody(assetRigidBody);
+		Game::dynamicsWorld->addRigidBody(assetRigidBody, ECollisionLayers::Group(collisionLayer), ECollisionLayers::Mask(collisionLayer));
+	}
+}
 
-		q.w = trans.getRotation().getW();
-		q.x = trans.getRotation().getX();
-		q.y = trans.getRotation().getY();
-		q.z = trans.getRotation().getZ();
+DllExport int Asset::getCollisionLayer()
+{
+	return collisionLayer;
+}
 
-	}
+// called every frame for game logic
+void Asset::Tick(GLFWwindow * window, double deltaTime)
+{
 	OnTick(window, deltaTime, this);
 }
 
@@ -188,6 +231,16 @@ DllExport void Asset::setTickFunction(void(*tickFunction)(GLFWwindow *window, do
 	OnTick = tickFunction;
 }
 
+DllExport void Asset::setCollisionEvents(unsigned int mask)
+{
+	collisionEventMask = mask;
+}
+
+DllExport void Asset::setCollisionFunction(void(*collisionFunction)(const ECollisionEvent& collision, Asset* asset))
+{
+	OnCollision = collisionFunction;
+}
+
 void Asset::SetupAsset()
 {
 
@@ -195,14 +248,53 @@ void Asset::SetupAsset()
 
 void Asset::Destroy()
 {
+	// deletes the soft bodies of the asset while it is still their parent, so they take their meshes out of the components.
+	// Soft bodies of other assets may be anchored to the rigid body
+	ESoftBody::Forget(this);
 	for each (AssetComponent* as in components)
 	{
 		as->parents.erase(std::remove(as->parents.begin(), as->parents.end(), this), as->parents.end());
 	}
 	Game::assetsToDelete.push_back(this);
-	Game::dynamicsWorld->removeRigidBody(assetRigidBody);
+	ECollisionEvents::Forget(this);
+	if (assetRigidBody != nullptr) {
+		// the step must not see the body while it gets deleted
+		lock_guard<mutex> lock(Game::physicsMutex);
+		Game::dynamicsWorld->removeRigidBody(assetRigidBody);
+
+		// the motion state drops a pending render sync when it is deleted
+		delete assetRigidBody;
+		delete assetMotionState;
+		assetRigidBody = nullptr;
+		assetMotionState = nullptr;
+	}
+	// after the body is gone, so no step can report it again
+	ETriggerVolume::Forget(this);
+}
 
-	delete assetRigidBody;
+DllExport void Asset::setCcd(float motionThreshold, float sweptSphereRadius)
+{
+	ccdAuto = false;
+	ccdMotionThreshold = motionThreshold;
+	ccdSweptSphereRadius = sweptSphereRadius;
+}
+
+DllExport void Asset::setCcdAuto()
+{
+	ccdAuto = true;
+	updateCcd();
+}
+
+DllExport void Asset::setCcdEnabled(bool enabled)
+{
+	ccdEnabled = enabled;
+}
+
+void Asset::updateCcd()
+{
+	if (ccdAuto && btAssetShape != nullptr) {
+		EContinuousCollision::Derive(btAssetShape, ccdMotionThreshold, ccdSweptSphereRadius);
+	}
 }
 
 void Asset::setHeightmapCollision(const char * path)
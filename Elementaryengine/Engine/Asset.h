@@ -4,6 +4,8 @@
 #include <EEngine.h>
 #include <AssetComponent.h>
 #include <Texture.h>
+#include <EMotionState.h>
+#include <ECollisionLayers.h>
 #include <btBulletDynamicsCommon.h>
 #include <BulletCollision\Gimpact\btGImpactCollisionAlgorithm.h>
 
@@ -12,13 +14,20 @@
 using namespace glm;
 using namespace std;
 static void defaultOnTick(GLFWwindow * window, double deltaTime, Asset* asset){}
-enum assetShapes{ball,cube};
+struct ECollisionEvent;
+static void defaultOnCollision(const ECollisionEvent& collision, Asset* asset){}
+enum assetShapes{ball,cube,convexHulls};
+class Model;
 
 class Asset
 {
 public:
 	DllExport Asset();
 	DllExport Asset(vec3 pos, vec3 scale, int mass, assetShapes shape);
+	///<summary>
+	///creates an asset that collides with the convex decomposition of the model
+	///</summary>
+	DllExport Asset(vec3 pos, vec3 scale, int mass, Model* collisionModel);
 	DllExport void setMass(float m);
 	DllExport void setScale(vec3 sca);
 	DllExport void setPosition(vec3 pos);
@@ -36,12 +45,44 @@ public:
 
 	DllExport btRigidBody* getRigidBody();
 
+	///<summary>
+	///moves the asset to a collision layer, see ECollisionLayers. Static assets start on the static layer, all others on the default layer
+	///</summary>
+	DllExport void setCollisionLayer(int layer);
+	DllExport int getCollisionLayer();
+
+	///<summary>
+	///sets the continuous collision settings manually instead of deriving them from the shape, see EContinuousCollision
+	///</summary>
+	DllExport void setCcd(float motionThreshold, float sweptSphereRadius);
+	///<summary>
+	///derives the continuous collision settings from the collision shape again (default)
+	///</summary>
+	DllExport void setCcdAuto();
+	DllExport void setCcdEnabled(bool enabled);
+	bool ccdEnabled = true;
+	bool ccdAuto = true;
+	float ccdMotionThreshold = 0;
+	float ccdSweptSphereRadius = 0;
+
 	float mass = 1;
 
 	// called ecery frame for game logic
 	DllExport virtual void Tick(GLFWwindow * window, double deltaTime);
 	DllExport void setTickFunction(void(*tickFunction)(GLFWwindow * window, double deltaTime, Asset* asset));
 	void (*OnTick)(GLFWwindow * window, double deltaTime, Asset* asset);
+
+	///<summary>
+	///subscribe to collision events, a combination of ECollisionEventType flags. 0 (default) for no events
+	///</summary>
+	DllExport void setCollisionEvents(unsigned int mask);
+	///<summary>
+	///called on the game thread for every subscribed collision event of this asset
+	///</summary>
+	DllExport void setCollisionFunction(void(*collisionFunction)(const ECollisionEvent& collision, Asset* asset));
+	void (*OnCollision)(const ECollisionEvent& collision, Asset* asset) = &defaultOnCollision;
+	unsigned int collisionEventMask = 0;
+	int collisionLayer = ECollisionLayers::defaultLayer;
 	glm::vec3 position;
 	glm::vec3 rotation;
 	glm::vec3 scale;
@@ -53,6 +94,7 @@ public:
 	vec3 collisionPosOffset = vec3(0);
 
 	assetShapes assetShape = assetShapes::ball;
+	Model* collisionModel = nullptr;
 	bool renderEnvironment = false;
 	static const unsigned int ENVIRONMENT_WIDTH, ENVIRONMENT_HEIGHT;
 	static unsigned int envMapFBO;
@@ -71,8 +113,11 @@ public:
 
 	DllExport void setHeightmapCollision(const char* path);
 private:
-	btDefaultMotionState* assetMotionState;
-	btCollisionShape* btAssetShape;
-	btRigidBody* assetRigidBody;
+	void createRigidBody(int mass);
+	btCollisionShape* createCollisionShape();
+	void updateCcd();
+	EMotionState* assetMotionState = nullptr;
+	btCollisionShape* btAssetShape = nullptr;
+	btRigidBody* assetRigidBody = nullptr;
 };
 
@@ -0,0 +1,164 @@
+#include "ECollisionEvents.h"
+#include <Game.h>
+#include <ETriggerVolume.h>
+#include <algorithm>
+
+atomic<unsigned int> ECollisionEvents::droppedEvents(0);
+bool ECollisionEvents::muted = false;
+map<pair<const btCollisionObject*, const btCollisionObject*>, ECollisionEvents::ContactPair> ECollisionEvents::pairs;
+unsigned int ECollisionEvents::step = 0;
+ELockFreeQueue<ECollisionEvent, 4096> ECollisionEvents::queue;
+vector<Asset*> ECollisionEvents::forgotten;
+mutex ECollisionEvents::forgottenMutex;
+vector<ECollisionEvent> ECollisionEvents::pending;
+
+void ECollisionEvents::Setup(btDynamicsWorld * world)
+{
+	world->setInternalTickCallback(StepCallback, nullptr, false);
+}
+
+// only rigid bodies of assets take part, ghost objects and soft bodies are ignored
+static Asset* AssetOf(const btCollisionObject* object)
+{
+	if (btRigidBody::upcast(object) == nullptr)
+		return nullptr;
+	return static_cast<Asset*>(object->getUserPointer());
+}
+
+void ECollisionEvents::StepCallback(btDynamicsWorld * world, btScalar timeStep)
+{
+	if (muted)
+		return;
+	step++;
+
+	// drop the pairs of destroyed assets before their bodies could show up again
+	{
+		lock_guard<mutex> lock(forgottenMutex);
+		for each (Asset* a in forgotten)
+		{
+			for (auto it = pairs.begin(); it != pairs.end();)
+			{
+				if (it->second.assetA == a || it->second.assetB == a)
+					it = pairs.erase(it);
+				else
+					++it;
+			}
+		}
+		forgotten.clear();
+	}
+
+	btDispatcher* dispatcher = world->getDispatcher();
+	int manifoldCount = dispatcher->getNumManifolds();
+	for (int i = 0; i < manifoldCount; i++)
+	{
+		btPersistentManifold* manifold = dispatcher->getManifoldByIndexInternal(i);
+		Asset* assetA = AssetOf(manifold->getBody0());
+		Asset* assetB = AssetOf(manifold->getBody1());
+		if (assetA == nullptr || assetB == nullptr)
+			continue;
+		// nobody listens to this pair
+		if (((assetA->collisionEventMask | assetB->collisionEventMask) & collisionAll) == 0)
+			continue;
+
+		// use the point that took the biggest impulse as the contact point
+		float impulse = 0;
+		int strongest = -1;
+		for (int p = 0; p < manifold->getNumContacts(); p++)
+		{
+			const btManifoldPoint& point = manifold->getContactPoint(p);
+			if (point.getDistance() > 0)
+				continue;
+			impulse += point.getAppliedImpulse();
+			if (strongest < 0 || point.getAppliedImpulse() > manifold->getContactPoint(strongest).getAppliedImpulse())
+				strongest = p;
+		}
+		if (strongest < 0)
+			continue;
+
+		const btCollisionObject* a = manifold->getBody0();
+		const btCollisionObject* b = manifold->getBody1();
+		auto key = a < b ? make_pair(a, b) : make_pair(b, a);
+		auto found = pairs.find(key);
+		bool begins = found == pairs.end();
+		ContactPair& contact = begins ? pairs[key] : found->second;
+		contact.assetA = assetA;
+		contact.assetB = assetB;
+		contact.point = Game::toGlm(manifold->getContactPoint(strongest).getPositionWorldOnB());
+		contact.normal = Game::toGlm(manifold->getContactPoint(strongest).m_normalWorldOnB);
+		contact.lastStep = step;
+		Emit(begins ? collisionBegin : collisionPersist, contact, impulse);
+	}
+
+	// pairs that had no contact this step have ended
+	for (auto it = pairs.begin(); it != pairs.end();)
+	{
+		if (it->second.lastStep != step) {
+			Emit(collisionEnd, it->second, 0);
+			it = pairs.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+
+	ETriggerVolume::Step(world);
+}
+
+void ECollisionEvents::Emit(ECollisionEventType type, const ContactPair & pair, float impulse)
+{
+	if (((pair.assetA->collisionEventMask | pair.assetB->collisionEventMask) & type) == 0)
+		return;
+	ECollisionEvent e;
+	e.type = type;
+	e.assetA = pair.assetA;
+	e.assetB = pair.assetB;
+	e.point = pair.point;
+	e.normal = pair.normal;
+	e.impulse = impulse;
+	if (!queue.Push(e))
+		droppedEvents++;
+}
+
+void ECollisionEvents::Drain()
+{
+	ECollisionEvent e;
+	while (queue.Pop(e))
+		pending.push_back(e);
+}
+
+void ECollisionEvents::Dispatch()
+{
+	Drain();
+	if (pending.empty())
+		return;
+
+	for each (ECollisionEvent e in pending)
+	{
+		if (e.assetA->collisionEventMask & e.type)
+			e.assetA->OnCollision(e, e.assetA);
+		if (e.assetB->collisionEventMask & e.type)
+			e.assetB->OnCollision(e, e.assetB);
+	}
+
+	Game& game = Game::Instance();
+	if (game.gameMode != nullptr) {
+		game.gameMode->OnCollision(pending);
+	}
+	game.eScriptContext->RunCollisionHandler(pending);
+
+	pending.clear();
+}
+
+void ECollisionEvents::Forget(Asset * asset)
+{
+	lock_guard<mutex> lock(forgottenMutex);
+	forgotten.push_back(asset);
+}
+
+void ECollisionEvents::DropEvents(Asset * asset)
+{
+	Drain();
+	pending.erase(std::remove_if(pending.begin(), pending.end(), [asset](const ECollisionEvent& e) {
+		return e.assetA == asset || e.assetB == asset;
+	}), pending.end());
+}
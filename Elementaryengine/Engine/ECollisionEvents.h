@@ -0,0 +1,133 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+#include <atomic>
+#include <mutex>
+#include <map>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+///<summary>
+///event types, combine them to a subscription mask with Asset::setCollisionEvents
+///</summary>
+enum ECollisionEventType
+{
+	collisionBegin = 1,
+	collisionPersist = 2,
+	collisionEnd = 4,
+	collisionAll = 7
+};
+
+///<summary>
+///contact between two assets, point and normal are in world space, the normal points from assetB to assetA
+///</summary>
+struct DllExport ECollisionEvent
+{
+	ECollisionEventType type;
+	Asset* assetA;
+	Asset* assetB;
+	vec3 point;
+	vec3 normal;
+	float impulse;
+};
+
+///<summary>
+///single producer single consumer queue that does not block either side. Push fails if the queue is full
+///</summary>
+template<typename T, unsigned int Capacity>
+class ELockFreeQueue
+{
+public:
+	bool Push(const T& item)
+	{
+		unsigned int tail = this->tail.load(memory_order_relaxed);
+		if (tail - head.load(memory_order_acquire) >= Capacity)
+			return false;
+		items[tail % Capacity] = item;
+		this->tail.store(tail + 1, memory_order_release);
+		return true;
+	}
+
+	bool Pop(T& item)
+	{
+		unsigned int head = this->head.load(memory_order_relaxed);
+		if (head == tail.load(memory_order_acquire))
+			return false;
+		item = items[head % Capacity];
+		this->head.store(head + 1, memory_order_release);
+		return true;
+	}
+
+private:
+	T items[Capacity];
+	atomic<unsigned int> head{ 0 };
+	atomic<unsigned int> tail{ 0 };
+};
+
+///<summary>
+///turns the narrowphase manifolds into begin/persist/end events once per physics step and delivers them batched on the game thread. The step also updates the trigger volumes
+///</summary>
+class DllExport ECollisionEvents
+{
+public:
+	///<summary>
+	///registers the step callback with the world
+	///</summary>
+	static void Setup(btDynamicsWorld* world);
+
+	///<summary>
+	///delivers the queued events to the assets, the GameMode and the script function OnCollision(events). Call on the game thread
+	///</summary>
+	static void Dispatch();
+
+	///<summary>
+	///removes everything that refers to the asset, call when it gets destroyed
+	///</summary>
+	static void Forget(Asset* asset);
+
+	///<summary>
+	///removes queued events of an asset that is about to be deleted. Call on the game thread
+	///</summary>
+	static void DropEvents(Asset* asset);
+
+	///<summary>
+	///number of events lost because the queue was full
+	///</summary>
+	static atomic<unsigned int> droppedEvents;
+
+	///<summary>
+	///while true the steps report nothing, neither contacts nor trigger volumes. Used for steps that are thrown away, like the replay check. Change it only while holding Game::physicsMutex
+	///</summary>
+	static bool muted;
+
+private:
+	struct ContactPair
+	{
+		Asset* assetA;
+		Asset* assetB;
+		vec3 point;
+		vec3 normal;
+		unsigned int lastStep;
+	};
+
+	// physics thread
+	static void StepCallback(btDynamicsWorld* world, btScalar timeStep);
+	static void Emit(ECollisionEventType type, const ContactPair& pair, float impulse);
+	static map<pair<const btCollisionObject*, const btCollisionObject*>, ContactPair> pairs;
+	static unsigned int step;
+
+	// physics thread to game thread
+	static ELockFreeQueue<ECollisionEvent, 4096> queue;
+
+	// game thread to physics thread
+	static vector<Asset*> forgotten;
+	static mutex forgottenMutex;
+
+	// game thread
+	static void Drain();
+	static vector<ECollisionEvent> pending;
+};
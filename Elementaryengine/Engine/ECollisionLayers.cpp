@@ -0,0 +1,116 @@
+#include "ECollisionLayers.h"
+#include <Game.h>
+
+vector<string> ECollisionLayers::names = { "Default", "Static", "Debris", "Trigger" };
+
+// everything collides with everything, except static with static and debris with debris
+int ECollisionLayers::matrix[maxLayers] = {
+	allLayers,
+	allLayers & ~(1 << staticLayer),
+	allLayers & ~(1 << debrisLayer),
+	allLayers, allLayers, allLayers, allLayers, allLayers,
+	allLayers, allLayers, allLayers, allLayers, allLayers, allLayers, allLayers, allLayers
+};
+
+int ECollisionLayers::Add(string name)
+{
+	int layer = Get(name);
+	if (layer >= 0)
+		return layer;
+	if (names.size() >= maxLayers)
+		return -1;
+	names.push_back(name);
+	return (int)names.size() - 1;
+}
+
+int ECollisionLayers::Get(string name)
+{
+	for (int i = 0; i < (int)names.size(); i++)
+	{
+		if (names[i] == name)
+			return i;
+	}
+	return -1;
+}
+
+string ECollisionLayers::Name(int layer)
+{
+	if (layer < 0 || layer >= (int)names.size())
+		return "";
+	return names[layer];
+}
+
+void ECollisionLayers::SetCollides(int layerA, int layerB, bool collides)
+{
+	if (layerA < 0 || layerA >= maxLayers || layerB < 0 || layerB >= maxLayers)
+		return;
+	// the matrix has to stay symmetric, Bullet checks the filter both ways
+	if (collides) {
+		matrix[layerA] |= 1 << layerB;
+		matrix[layerB] |= 1 << layerA;
+	}
+	else {
+		matrix[layerA] &= ~(1 << layerB);
+		matrix[layerB] &= ~(1 << layerA);
+	}
+	Refilter();
+}
+
+bool ECollisionLayers::Collides(int layerA, int layerB)
+{
+	return (Mask(layerA) & Group(layerB)) != 0;
+}
+
+int ECollisionLayers::Group(int layer)
+{
+	if (layer < 0 || layer >= maxLayers)
+		return 0;
+	return 1 << layer;
+}
+
+int ECollisionLayers::Mask(int layer)
+{
+	if (layer < 0 || layer >= maxLayers)
+		return 0;
+	return matrix[layer];
+}
+
+void ECollisionLayers::Refilter()
+{
+	btDiscreteDynamicsWorld* world = Game::dynamicsWorld;
+	if (world == nullptr)
+		return;
+	lock_guard<mutex> lock(Game::physicsMutex);
+
+	// the broadphase only re-pairs proxies that move, so the objects get added again with their new mask
+	btCollisionObjectArray objects = world->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btCollisionObject* object = objects[i];
+		btBroadphaseProxy* proxy = object->getBroadphaseHandle();
+		int group = proxy->m_collisionFilterGroup;
+		// not on a single layer, leave it alone
+		if (group <= 0 || group > allLayers || (group & (group - 1)) != 0)
+			continue;
+		int layer = 0;
+		while ((group >> layer) != 1)
+			layer++;
+
+		btRigidBody* body = btRigidBody::upcast(object);
+		btSoftBody* softBody = btSoftBody::upcast(object);
+		if (body != nullptr) {
+			world->removeRigidBody(body);
+			world->addRigidBody(body, group, Mask(layer));
+		}
+		else if (softBody != nullptr) {
+			// only soft bodies have a soft body world
+			btSoftRigidDynamicsWorld* softWorld = static_cast<btSoftRigidDynamicsWorld*>(world);
+			softWorld->removeSoftBody(softBody);
+			softWorld->addSoftBody(softBody, group, Mask(layer));
+		}
+		else {
+			world->removeCollisionObject(object);
+			world->addCollisionObject(object, group, Mask(layer));
+		}
+	}
+}
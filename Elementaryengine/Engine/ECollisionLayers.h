@@ -0,0 +1,58 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+///<summary>
+///named collision layers and the layer vs layer matrix. Each layer is one Bullet collision filter group bit, its row of the matrix is the filter mask, so filtered pairs and queries are culled in the broadphase
+///</summary>
+class DllExport ECollisionLayers
+{
+public:
+	static const int maxLayers = 16;
+	static const int allLayers = (1 << maxLayers) - 1;
+
+	// built in layers
+	static const int defaultLayer = 0;
+	static const int staticLayer = 1;
+	static const int debrisLayer = 2;
+	static const int triggerLayer = 3;
+
+	///<summary>
+	///returns the layer with that name, creates it if it does not exist yet. -1 if all layers are taken
+	///</summary>
+	static int Add(string name);
+
+	///<summary>
+	///returns the layer with that name, -1 if there is none
+	///</summary>
+	static int Get(string name);
+
+	static string Name(int layer);
+
+	///<summary>
+	///sets if the two layers collide and refilters the bodies already in the world
+	///</summary>
+	static void SetCollides(int layerA, int layerB, bool collides);
+
+	static bool Collides(int layerA, int layerB);
+
+	///<summary>
+	///the Bullet collision filter group of a layer
+	///</summary>
+	static int Group(int layer);
+
+	///<summary>
+	///the Bullet collision filter mask of a layer: all layers it collides with
+	///</summary>
+	static int Mask(int layer);
+
+private:
+	static vector<string> names;
+	static int matrix[maxLayers];
+	static void Refilter();
+};
@@ -0,0 +1,46 @@
+#include "EContinuousCollision.h"
+#include <Game.h>
+
+float EContinuousCollision::speedThreshold = 10;
+float EContinuousCollision::motionFraction = 0.5f;
+float EContinuousCollision::sweptSphereFraction = 0.8f;
+
+void EContinuousCollision::Setup(btDynamicsWorld * world)
+{
+	world->setInternalTickCallback(PreStepCallback, nullptr, true);
+}
+
+void EContinuousCollision::Derive(const btCollisionShape * shape, float & motionThreshold, float & sweptSphereRadius)
+{
+	btVector3 aabbMin, aabbMax;
+	btTransform identity;
+	identity.setIdentity();
+	shape->getAabb(identity, aabbMin, aabbMax);
+	btVector3 extents = aabbMax - aabbMin;
+	float thinnest = (float)extents[extents.minAxis()];
+	motionThreshold = motionFraction * thinnest;
+	sweptSphereRadius = sweptSphereFraction * thinnest / 2;
+}
+
+void EContinuousCollision::PreStepCallback(btDynamicsWorld * world, btScalar timeStep)
+{
+	float threshold2 = speedThreshold * speedThreshold;
+	btCollisionObjectArray& objects = world->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btRigidBody* body = btRigidBody::upcast(objects[i]);
+		if (body == nullptr || body->isStaticOrKinematicObject() || !body->isActive())
+			continue;
+		Asset* asset = static_cast<Asset*>(body->getUserPointer());
+		if (asset == nullptr)
+			continue;
+		// Bullet sweeps the body whenever it moves further than the threshold, 0 turns CCD off
+		if (asset->ccdEnabled && body->getLinearVelocity().length2() > threshold2) {
+			body->setCcdMotionThreshold(asset->ccdMotionThreshold);
+			body->setCcdSweptSphereRadius(asset->ccdSweptSphereRadius);
+		}
+		else {
+			body->setCcdMotionThreshold(0);
+		}
+	}
+}
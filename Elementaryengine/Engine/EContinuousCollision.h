@@ -0,0 +1,45 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+///<summary>
+///continuous collision detection for small fast bodies, so they do not tunnel through geometry without raising the physics rate.
+///Each asset gets a motion threshold and swept sphere radius derived from its shape, CCD is only used while the body is faster than speedThreshold
+///</summary>
+class DllExport EContinuousCollision
+{
+public:
+	///<summary>
+	///bodies slower than this (units per second) never use CCD. 0 leaves it to the motion threshold of each body
+	///</summary>
+	static float speedThreshold;
+
+	///<summary>
+	///a body has to move this fraction of its thinnest extent in one step before CCD is used
+	///</summary>
+	static float motionFraction;
+
+	///<summary>
+	///radius of the swept sphere as a fraction of the thinnest half extent, a bit smaller than the shape so resting contacts are not caught
+	///</summary>
+	static float sweptSphereFraction;
+
+	///<summary>
+	///registers the per step update with the world
+	///</summary>
+	static void Setup(btDynamicsWorld* world);
+
+	///<summary>
+	///CCD settings for a shape from its size
+	///</summary>
+	static void Derive(const btCollisionShape* shape, float& motionThreshold, float& sweptSphereRadius);
+
+private:
+	// physics thread, before every step
+	static void PreStepCallback(btDynamicsWorld* world, btScalar timeStep);
+};
@@ -0,0 +1,373 @@
+#include "EConvexDecomposition.h"
+#include <LinearMath\btConvexHullComputer.h>
+#include <windows.h>
+#include <fstream>
+#include <algorithm>
+
+string EConvexDecomposition::cacheDirectory = "Cache/Hulls";
+bool EConvexDecomposition::useCache = true;
+
+static const unsigned int hullCacheMagic = 0x4C554845; // "EHUL"
+static const unsigned int hullCacheVersion = 1;
+
+// a part of the mesh during the decomposition, triangles holds three points per triangle
+struct EDecompositionPiece
+{
+	vector<btVector3> triangles;
+	vector<btVector3> hull;
+	btScalar volume = 0;
+	int depth = 0;
+};
+
+// computes the convex hull of the points and returns its volume
+static btScalar ComputeHull(const vector<btVector3>& points, vector<btVector3>& hullVertices)
+{
+	hullVertices.clear();
+	if (points.size() < 4) {
+		hullVertices = points;
+		return 0;
+	}
+	btConvexHullComputer computer;
+	computer.compute(&points[0].x(), sizeof(btVector3), (int)points.size(), 0, 0);
+	if (computer.vertices.size() == 0)
+		return 0;
+
+	btVector3 center(0, 0, 0);
+	for (int i = 0; i < computer.vertices.size(); i++)
+	{
+		hullVertices.push_back(computer.vertices[i]);
+		center += computer.vertices[i];
+	}
+	center /= btScalar(computer.vertices.size());
+
+	// sum up the tetrahedrons spanned by the center and a triangle fan of each face
+	btScalar volume = 0;
+	for (int f = 0; f < computer.faces.size(); f++)
+	{
+		const btConvexHullComputer::Edge* first = &computer.edges[computer.faces[f]];
+		const btVector3& a = computer.vertices[first->getSourceVertex()];
+		const btConvexHullComputer::Edge* edge = first->getNextEdgeOfFace();
+		while (edge->getTargetVertex() != first->getSourceVertex())
+		{
+			const btVector3& b = computer.vertices[edge->getSourceVertex()];
+			const btVector3& c = computer.vertices[edge->getTargetVertex()];
+			volume += btFabs((a - center).dot((b - center).cross(c - center))) / btScalar(6);
+			edge = edge->getNextEdgeOfFace();
+		}
+	}
+	return volume;
+}
+
+// keeps the part of the triangle on the positive side (side * (p[axis] - value) >= 0) and appends it as triangles
+static void ClipTriangle(const btVector3* triangle, int axis, btScalar value, btScalar side, vector<btVector3>& out)
+{
+	btVector3 polygon[4];
+	int count = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		const btVector3& a = triangle[i];
+		const btVector3& b = triangle[(i + 1) % 3];
+		btScalar da = (a[axis] - value) * side;
+		btScalar db = (b[axis] - value) * side;
+		if (da >= 0)
+			polygon[count++] = a;
+		if ((da >= 0) != (db >= 0))
+			polygon[count++] = a + (b - a) * (da / (da - db));
+	}
+	for (int i = 1; i + 1 < count; i++)
+	{
+		out.push_back(polygon[0]);
+		out.push_back(polygon[i]);
+		out.push_back(polygon[i + 1]);
+	}
+}
+
+static void SplitTriangles(const vector<btVector3>& triangles, int axis, btScalar value, vector<btVector3>& below, vector<btVector3>& above)
+{
+	below.clear();
+	above.clear();
+	for (size_t i = 0; i + 2 < triangles.size(); i += 3)
+	{
+		ClipTriangle(&triangles[i], axis, value, -1, below);
+		ClipTriangle(&triangles[i], axis, value, 1, above);
+	}
+}
+
+// tries the candidate planes and splits the piece along the one that removes the most empty hull volume
+static bool SplitPiece(const EDecompositionPiece& piece, const EConvexDecompositionSettings& settings, EDecompositionPiece& below, EDecompositionPiece& above)
+{
+	if (piece.volume <= SIMD_EPSILON || piece.triangles.empty())
+		return false;
+
+	btVector3 aabbMin = piece.triangles[0];
+	btVector3 aabbMax = piece.triangles[0];
+	for each (btVector3 p in piece.triangles)
+	{
+		aabbMin.setMin(p);
+		aabbMax.setMax(p);
+	}
+
+	btScalar bestVolume = piece.volume;
+	int bestAxis = -1;
+	btScalar bestValue = 0;
+	vector<btVector3> trianglesBelow, trianglesAbove, hullBelow, hullAbove;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		btScalar extent = aabbMax[axis] - aabbMin[axis];
+		if (extent <= SIMD_EPSILON)
+			continue;
+		for (int s = 1; s <= settings.planeSamples; s++)
+		{
+			btScalar value = aabbMin[axis] + extent * s / btScalar(settings.planeSamples + 1);
+			SplitTriangles(piece.triangles, axis, value, trianglesBelow, trianglesAbove);
+			if (trianglesBelow.empty() || trianglesAbove.empty())
+				continue;
+			btScalar volume = ComputeHull(trianglesBelow, hullBelow) + ComputeHull(trianglesAbove, hullAbove);
+			if (volume < bestVolume)
+			{
+				bestVolume = volume;
+				bestAxis = axis;
+				bestValue = value;
+			}
+		}
+	}
+
+	// only split if the children are noticeably tighter than the hull of the whole piece
+	if (bestAxis < 0 || (piece.volume - bestVolume) / piece.volume < settings.minVolumeGain)
+		return false;
+
+	SplitTriangles(piece.triangles, bestAxis, bestValue, below.triangles, above.triangles);
+	below.volume = ComputeHull(below.triangles, below.hull);
+	above.volume = ComputeHull(above.triangles, above.hull);
+	below.depth = above.depth = piece.depth + 1;
+	return true;
+}
+
+// reduces the hull to the support points of evenly distributed directions, which keeps the extents of the hull
+static vector<btVector3> ReduceHull(const vector<btVector3>& vertices, int maxVertices)
+{
+	if ((int)vertices.size() <= maxVertices || maxVertices < 4)
+		return vertices;
+
+	vector<btVector3> reduced;
+	const btScalar goldenAngle = SIMD_PI * (3 - btSqrt(5));
+	for (int i = 0; i < maxVertices; i++)
+	{
+		btScalar y = 1 - (i + btScalar(0.5)) * 2 / maxVertices;
+		btScalar r = btSqrt(1 - y * y);
+		btVector3 direction(btCos(goldenAngle * i) * r, y, btSin(goldenAngle * i) * r);
+
+		size_t best = 0;
+		btScalar bestDot = -BT_LARGE_FLOAT;
+		for (size_t j = 0; j < vertices.size(); j++)
+		{
+			btScalar d = direction.dot(vertices[j]);
+			if (d > bestDot)
+			{
+				bestDot = d;
+				best = j;
+			}
+		}
+		if (std::find(reduced.begin(), reduced.end(), vertices[best]) == reduced.end())
+			reduced.push_back(vertices[best]);
+	}
+	return reduced;
+}
+
+vector<vector<btVector3>> EConvexDecomposition::Decompose(const vector<Mesh*>& meshes, const EConvexDecompositionSettings& settings)
+{
+	vector<btVector3> triangles;
+	for each (Mesh* m in meshes)
+	{
+		for (size_t i = 0; i + 2 < m->indices.size(); i += 3)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				vec3 p = m->vertices[m->indices[i + k]].Position;
+				triangles.push_back(btVector3(p.x, p.y, p.z));
+			}
+		}
+	}
+
+	string path;
+	vector<vector<btVector3>> hulls;
+	if (useCache)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.ehull", Hash(triangles, settings));
+		path = cacheDirectory + "/" + name;
+		if (LoadCache(path, hulls))
+			return hulls;
+	}
+
+	hulls = DecomposeTriangles(triangles, settings);
+
+	if (useCache)
+		SaveCache(path, hulls);
+	return hulls;
+}
+
+vector<vector<btVector3>> EConvexDecomposition::DecomposeTriangles(const vector<btVector3>& triangles, const EConvexDecompositionSettings& settings)
+{
+	vector<vector<btVector3>> hulls;
+	if (triangles.size() < 3)
+		return hulls;
+
+	vector<EDecompositionPiece> open;
+	vector<EDecompositionPiece> leaves;
+
+	EDecompositionPiece root;
+	root.triangles = triangles;
+	root.volume = ComputeHull(root.triangles, root.hull);
+	open.push_back(std::move(root));
+
+	while (!open.empty())
+	{
+		// split the biggest piece first, so the hull budget goes where the most volume is gained
+		auto biggest = std::max_element(open.begin(), open.end(), [](const EDecompositionPiece& a, const EDecompositionPiece& b) { return a.volume < b.volume; });
+		EDecompositionPiece piece = std::move(*biggest);
+		open.erase(biggest);
+
+		EDecompositionPiece below, above;
+		bool budgetLeft = (int)(leaves.size() + open.size()) + 2 <= settings.maxHulls;
+		if (!budgetLeft || piece.depth >= settings.maxDepth || !SplitPiece(piece, settings, below, above))
+		{
+			leaves.push_back(std::move(piece));
+			continue;
+		}
+		open.push_back(std::move(below));
+		open.push_back(std::move(above));
+	}
+
+	for (size_t i = 0; i < leaves.size(); i++)
+	{
+		if (leaves[i].hull.empty())
+			continue;
+		hulls.push_back(ReduceHull(leaves[i].hull, settings.maxVerticesPerHull));
+	}
+	return hulls;
+}
+
+btCompoundShape * EConvexDecomposition::BuildCompound(const vector<vector<btVector3>>& hulls, btVector3 scale, float margin)
+{
+	btCompoundShape* compound = new btCompoundShape();
+	for (size_t i = 0; i < hulls.size(); i++)
+	{
+		const vector<btVector3>& hull = hulls[i];
+		// center the hull on its own origin so Bullet works with small local coordinates
+		btVector3 center(0, 0, 0);
+		for each (btVector3 p in hull)
+			center += p * scale;
+		center /= btScalar(hull.size());
+
+		btConvexHullShape* shape = new btConvexHullShape();
+		for each (btVector3 p in hull)
+			shape->addPoint(p * scale - center, false);
+		shape->recalcLocalAabb();
+		shape->setMargin(margin);
+
+		btTransform transform;
+		transform.setIdentity();
+		transform.setOrigin(center);
+		compound->addChildShape(transform, shape);
+	}
+	return compound;
+}
+
+unsigned long long EConvexDecomposition::Hash(const vector<btVector3>& triangles, const EConvexDecompositionSettings & settings)
+{
+	// FNV-1a over the positions, the settings and the cache version
+	unsigned long long hash = 14695981039346656037ull;
+	auto add = [&hash](const void* data, size_t size) {
+		const unsigned char* bytes = (const unsigned char*)data;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+	add(&hullCacheVersion, sizeof(hullCacheVersion));
+	for each (btVector3 p in triangles)
+	{
+		float xyz[3] = { (float)p.x(), (float)p.y(), (float)p.z() };
+		add(xyz, sizeof(xyz));
+	}
+	add(&settings.maxHulls, sizeof(settings.maxHulls));
+	add(&settings.maxDepth, sizeof(settings.maxDepth));
+	add(&settings.minVolumeGain, sizeof(settings.minVolumeGain));
+	add(&settings.planeSamples, sizeof(settings.planeSamples));
+	add(&settings.maxVerticesPerHull, sizeof(settings.maxVerticesPerHull));
+	return hash;
+}
+
+bool EConvexDecomposition::LoadCache(const string& path, vector<vector<btVector3>>& hulls)
+{
+	ifstream file(path, ios::binary | ios::ate);
+	if (!file.is_open())
+		return false;
+	unsigned long long remaining = (unsigned long long)file.tellg();
+	file.seekg(0);
+
+	unsigned int header[3];
+	if (remaining < sizeof(header) || !file.read((char*)header, sizeof(header)) || header[0] != hullCacheMagic || header[1] != hullCacheVersion)
+		return false;
+	remaining -= sizeof(header);
+
+	// the counts are checked against the rest of the file before anything is allocated, a corrupt file is decomposed again
+	unsigned int hullCount = header[2];
+	if (hullCount > remaining / sizeof(unsigned int))
+		return false;
+	hulls.resize(hullCount);
+	for (unsigned int i = 0; i < hullCount; i++)
+	{
+		unsigned int count;
+		if (remaining < sizeof(count) || !file.read((char*)&count, sizeof(count))) {
+			hulls.clear();
+			return false;
+		}
+		remaining -= sizeof(count);
+		unsigned long long bytes = (unsigned long long)count * 3 * sizeof(float);
+		if (bytes > remaining) {
+			hulls.clear();
+			return false;
+		}
+		vector<float> xyz((size_t)count * 3);
+		if (count > 0 && !file.read((char*)xyz.data(), xyz.size() * sizeof(float))) {
+			hulls.clear();
+			return false;
+		}
+		remaining -= bytes;
+		for (unsigned int j = 0; j < count; j++)
+			hulls[i].push_back(btVector3(xyz[j * 3], xyz[j * 3 + 1], xyz[j * 3 + 2]));
+	}
+	return true;
+}
+
+void EConvexDecomposition::SaveCache(const string& path, const vector<vector<btVector3>>& hulls)
+{
+	// create the cache directory one level at a time
+	for (size_t i = cacheDirectory.find_first_of("/\\"); ; i = cacheDirectory.find_first_of("/\\", i + 1))
+	{
+		CreateDirectoryA(cacheDirectory.substr(0, i).c_str(), NULL);
+		if (i == string::npos)
+			break;
+	}
+
+	ofstream file(path, ios::binary | ios::trunc);
+	if (!file.is_open())
+		return;
+
+	unsigned int header[3] = { hullCacheMagic, hullCacheVersion, (unsigned int)hulls.size() };
+	file.write((const char*)header, sizeof(header));
+	for (size_t i = 0; i < hulls.size(); i++)
+	{
+		const vector<btVector3>& hull = hulls[i];
+		unsigned int count = (unsigned int)hull.size();
+		file.write((const char*)&count, sizeof(count));
+		for each (btVector3 p in hull)
+		{
+			float xyz[3] = { (float)p.x(), (float)p.y(), (float)p.z() };
+			file.write((const char*)xyz, sizeof(xyz));
+		}
+	}
+}
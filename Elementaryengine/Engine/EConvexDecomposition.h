@@ -0,0 +1,74 @@
+#pragma once
+#include <EEngine.h>
+#include <Mesh.h>
+#include <btBulletDynamicsCommon.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+///<summary>
+///parameters of the approximate convex decomposition, all but the margin are part of the cache key
+///</summary>
+struct DllExport EConvexDecompositionSettings
+{
+	// upper bound for the number of hulls in the compound
+	int maxHulls = 16;
+	// maximum recursion depth of the splitting
+	int maxDepth = 8;
+	// a piece is only split if that removes at least this fraction of its hull volume
+	float minVolumeGain = 0.05f;
+	// number of candidate split planes tried per axis
+	int planeSamples = 8;
+	// vertex budget of each generated hull
+	int maxVerticesPerHull = 32;
+	// collision margin of the generated hulls
+	float margin = 0.01f;
+};
+
+///<summary>
+///approximate convex decomposition (V-HACD style, recursive plane splitting on the CPU) of triangle meshes into compounds of convex hulls
+///</summary>
+class DllExport EConvexDecomposition
+{
+public:
+	///<summary>
+	///decomposes the meshes into convex hulls, loads the result from the disk cache if the same meshes were decomposed with the same settings before
+	///</summary>
+	///<param name="meshes">
+	///the meshes to decompose, the hulls are in the local space of the meshes
+	///</param>
+	///<param name="settings">
+	///decomposition parameters
+	///</param>
+	///<returns>
+	///the convex hulls, each as a list of points
+	///</returns>
+	static vector<vector<btVector3>> Decompose(const vector<Mesh*>& meshes, const EConvexDecompositionSettings& settings);
+
+	///<summary>
+	///decomposes a triangle soup (three points per triangle) without touching the cache
+	///</summary>
+	static vector<vector<btVector3>> DecomposeTriangles(const vector<btVector3>& triangles, const EConvexDecompositionSettings& settings);
+
+	///<summary>
+	///builds a compound of btConvexHullShapes from hull points, the points get scaled by the given factor
+	///</summary>
+	static btCompoundShape* BuildCompound(const vector<vector<btVector3>>& hulls, btVector3 scale, float margin);
+
+	///<summary>
+	///directory the decomposition results get cached in
+	///</summary>
+	static string cacheDirectory;
+
+	///<summary>
+	///disable to always run the decomposition
+	///</summary>
+	static bool useCache;
+
+private:
+	static unsigned long long Hash(const vector<btVector3>& triangles, const EConvexDecompositionSettings& settings);
+	static bool LoadCache(const string& path, vector<vector<btVector3>>& hulls);
+	static void SaveCache(const string& path, const vector<vector<btVector3>>& hulls);
+};
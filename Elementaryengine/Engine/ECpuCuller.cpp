@@ -0,0 +1,179 @@
+#include "ECpuCuller.h"
+#include <Game.h>
+#include <EJobSystem.h>
+#include <immintrin.h>
+#include <limits>
+
+void ECpuCuller::SetInstances(const vector<Mesh*>& meshes)
+{
+	this->meshes = meshes;
+	meshFirst.clear();
+	instanceAsset.clear();
+	instanceMesh.clear();
+	for (unsigned int m = 0; m < meshes.size(); m++)
+	{
+		meshFirst.push_back((unsigned int)instanceAsset.size());
+		for each (Asset* a in meshes[m]->parents)
+		{
+			instanceAsset.push_back(a);
+			instanceMesh.push_back(m);
+		}
+	}
+	meshFirst.push_back((unsigned int)instanceAsset.size());
+
+	// the padding is never read back, it only keeps the last wide load inside the arrays
+	size_t padded = (instanceAsset.size() + 7) / 8 * 8;
+	centerX.assign(padded, 0);
+	centerY.assign(padded, 0);
+	centerZ.assign(padded, 0);
+	radius.assign(padded, 0);
+	instanceVisible.assign(padded, 0);
+	visible.assign(meshes.size(), vector<Asset*>());
+}
+
+void ECpuCuller::Cull(const mat4& viewProjection, vec3 eye, float maxDistance, const vector<vec4>& keepSpheres)
+{
+	// the frustum planes from the rows of the view projection matrix, normalized so the sphere radius can be compared to the distance
+	vec4 planes[6];
+	for (int i = 0; i < 6; i++)
+	{
+		int row = i / 2;
+		float side = (i % 2 == 0) ? 1.0f : -1.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			planes[i][c] = viewProjection[c][3] + side * viewProjection[c][row];
+		}
+		planes[i] /= length(vec3(planes[i]));
+	}
+
+	unsigned int count = (unsigned int)instanceAsset.size();
+	unsigned int blocks = (count + blockSize - 1) / blockSize;
+	EJobSystem::ParallelFor(blocks, [&](unsigned int b) {
+		unsigned int begin = b * blockSize;
+		cullBlock(begin, (std::min)(begin + blockSize, count), planes, eye, maxDistance, keepSpheres);
+	});
+
+	// the instances of a mesh are consecutive, so every mesh collects its own list
+	EJobSystem::ParallelFor((unsigned int)meshes.size(), [&](unsigned int m) {
+		vector<Asset*>& list = visible[m];
+		list.clear();
+		for (unsigned int i = meshFirst[m]; i < meshFirst[m + 1]; i++)
+		{
+			if (instanceVisible[i]) {
+				list.push_back(instanceAsset[i]);
+			}
+		}
+	}, 16);
+}
+
+void ECpuCuller::cullBlock(unsigned int begin, unsigned int end, const vec4* planes, vec3 eye, float maxDistance, const vector<vec4>& keepSpheres)
+{
+	// world space spheres, the model matrix is translate * scale * rotation
+	for (unsigned int i = begin; i < end; i++)
+	{
+		Asset* a = instanceAsset[i];
+		Mesh* m = meshes[instanceMesh[i]];
+		vec3 scale = a->scale + m->scaleOffset;
+		vec3 center = a->position + m->posOffset + scale * (a->q * vec3(m->bounds));
+		centerX[i] = center.x;
+		centerY[i] = center.y;
+		centerZ[i] = center.z;
+		// meshes without bounds (or with moving vertices) are never culled
+		if (m->bounds.w < 0 || m->dynamicVertices) {
+			radius[i] = numeric_limits<float>::infinity();
+		}
+		else {
+			radius[i] = m->bounds.w * (std::max)(abs(scale.x), (std::max)(abs(scale.y), abs(scale.z)));
+		}
+	}
+
+#ifdef __AVX__
+	const unsigned int width = 8;
+	for (unsigned int i = begin; i < end; i += width)
+	{
+		__m256 x = _mm256_loadu_ps(&centerX[i]);
+		__m256 y = _mm256_loadu_ps(&centerY[i]);
+		__m256 z = _mm256_loadu_ps(&centerZ[i]);
+		__m256 r = _mm256_loadu_ps(&radius[i]);
+		__m256 negativeR = _mm256_sub_ps(_mm256_setzero_ps(), r);
+
+		// inside all planes
+		__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].x), x), _mm256_mul_ps(_mm256_set1_ps(planes[p].y), y)),
+				_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].z), z), _mm256_set1_ps(planes[p].w)));
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negativeR, _CMP_GE_OQ));
+		}
+
+		// and close enough
+		__m256 dx = _mm256_sub_ps(x, _mm256_set1_ps(eye.x));
+		__m256 dy = _mm256_sub_ps(y, _mm256_set1_ps(eye.y));
+		__m256 dz = _mm256_sub_ps(z, _mm256_set1_ps(eye.z));
+		__m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		__m256 limit = _mm256_add_ps(_mm256_set1_ps(maxDistance), r);
+		inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_mul_ps(limit, limit), _CMP_LE_OQ));
+
+		// or touching a keep sphere
+		for each (vec4 keep in keepSpheres)
+		{
+			dx = _mm256_sub_ps(x, _mm256_set1_ps(keep.x));
+			dy = _mm256_sub_ps(y, _mm256_set1_ps(keep.y));
+			dz = _mm256_sub_ps(z, _mm256_set1_ps(keep.z));
+			distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+			limit = _mm256_add_ps(_mm256_set1_ps(keep.w), r);
+			inside = _mm256_or_ps(inside, _mm256_cmp_ps(distance, _mm256_mul_ps(limit, limit), _CMP_LE_OQ));
+		}
+
+		int mask = _mm256_movemask_ps(inside);
+		for (unsigned int k = 0; k < width; k++)
+		{
+			instanceVisible[i + k] = (mask >> k) & 1;
+		}
+	}
+#else
+	const unsigned int width = 4;
+	for (unsigned int i = begin; i < end; i += width)
+	{
+		__m128 x = _mm_loadu_ps(&centerX[i]);
+		__m128 y = _mm_loadu_ps(&centerY[i]);
+		__m128 z = _mm_loadu_ps(&centerZ[i]);
+		__m128 r = _mm_loadu_ps(&radius[i]);
+		__m128 negativeR = _mm_sub_ps(_mm_setzero_ps(), r);
+
+		// inside all planes
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (int p = 0; p < 6; p++)
+		{
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), x), _mm_mul_ps(_mm_set1_ps(planes[p].y), y)),
+				_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z), z), _mm_set1_ps(planes[p].w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negativeR));
+		}
+
+		// and close enough
+		__m128 dx = _mm_sub_ps(x, _mm_set1_ps(eye.x));
+		__m128 dy = _mm_sub_ps(y, _mm_set1_ps(eye.y));
+		__m128 dz = _mm_sub_ps(z, _mm_set1_ps(eye.z));
+		__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 limit = _mm_add_ps(_mm_set1_ps(maxDistance), r);
+		inside = _mm_and_ps(inside, _mm_cmple_ps(distance, _mm_mul_ps(limit, limit)));
+
+		// or touching a keep sphere
+		for each (vec4 keep in keepSpheres)
+		{
+			dx = _mm_sub_ps(x, _mm_set1_ps(keep.x));
+			dy = _mm_sub_ps(y, _mm_set1_ps(keep.y));
+			dz = _mm_sub_ps(z, _mm_set1_ps(keep.z));
+			distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			limit = _mm_add_ps(_mm_set1_ps(keep.w), r);
+			inside = _mm_or_ps(inside, _mm_cmple_ps(distance, _mm_mul_ps(limit, limit)));
+		}
+
+		int mask = _mm_movemask_ps(inside);
+		for (unsigned int k = 0; k < width; k++)
+		{
+			instanceVisible[i + k] = (mask >> k) & 1;
+		}
+	}
+#endif
+}
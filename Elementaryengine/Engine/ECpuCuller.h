@@ -0,0 +1,56 @@
+#pragma once
+#include <EEngine.h>
+#include <vector>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+class Mesh;
+class Asset;
+
+///<summary>
+///frustum and distance culling of the mesh instances on the CPU. The bounding spheres are kept as a structure of arrays and tested four at a time
+///(eight when built with AVX), the blocks of instances and the visible lists of the meshes are split over the job system
+///</summary>
+class DllExport ECpuCuller
+{
+public:
+	///<summary>
+	///sets the instances to cull, every parent of every mesh. Call again when the meshes or their parents change
+	///</summary>
+	void SetInstances(const vector<Mesh*>& meshes);
+
+	///<summary>
+	///moves the spheres to the current transforms of their assets and fills the visible lists. An instance is visible if it is inside the frustum
+	///of viewProjection and not further than maxDistance from eye, or if it touches one of the keep spheres (xyz = center, w = radius)
+	///</summary>
+	void Cull(const mat4& viewProjection, vec3 eye, float maxDistance, const vector<vec4>& keepSpheres);
+
+	///<summary>
+	///the visible parents of every mesh, in the order the meshes were given to SetInstances
+	///</summary>
+	vector<vector<Asset*>> visible;
+
+	// instances tested by one job
+	static const unsigned int blockSize = 1024;
+
+private:
+	// updates the spheres of [begin, end) and writes their visibility
+	void cullBlock(unsigned int begin, unsigned int end, const vec4* planes, vec3 eye, float maxDistance, const vector<vec4>& keepSpheres);
+
+	vector<Mesh*> meshes;
+	// first instance of every mesh, one more entry than meshes
+	vector<unsigned int> meshFirst;
+	vector<Asset*> instanceAsset;
+	vector<unsigned int> instanceMesh;
+
+	// world space bounding spheres, padded to a multiple of eight
+	vector<float> centerX;
+	vector<float> centerY;
+	vector<float> centerZ;
+	vector<float> radius;
+	vector<unsigned char> instanceVisible;
+};
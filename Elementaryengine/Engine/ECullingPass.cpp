@@ -0,0 +1,74 @@
+#include "ECullingPass.h"
+#include <Game.h>
+
+Shader* ECullingPass::cullShader = nullptr;
+
+ECullingPass::ECullingPass(EHiZPass* hiZ, bool late)
+{
+	this->hiZ = hiZ;
+	this->late = late;
+}
+
+
+ECullingPass::~ECullingPass()
+{
+}
+
+void ECullingPass::Render()
+{
+	EOpenGl* eOpenGl = Game::eOpenGl;
+	int commandCount = eOpenGl->dICommands.size();
+	int instanceCount = eOpenGl->instanceDraw.size();
+	if (commandCount == 0)
+		return;
+	ERenderPass::Render();
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, eOpenGl->gVisibleInstanceBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, eOpenGl->gCulledIndirectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 12, eOpenGl->gLateIndirectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 13, eOpenGl->gOccludedInstanceBuffer);
+
+	// the early pass tests against the pyramid of the last frame, the late pass against the one built from the early draws
+	bool useHiZ = hiZ != nullptr && hiZ->Valid;
+	uniformUseHiZ.Update(useHiZ);
+	if (useHiZ) {
+		glActiveTexture(GL_TEXTURE0 + EHiZPass::textureUnit);
+		glBindTexture(GL_TEXTURE_2D, hiZ->Pyramid);
+		glActiveTexture(GL_TEXTURE0);
+		uniformHiZVP.Update(hiZ->ViewProjection);
+		uniformHiZSize.Update(vec2(hiZ->Width, hiZ->Height));
+	}
+
+	// reset the instance count of every command, the late commands start behind the early ones
+	uniformStage.Update(late ? 2 : 0);
+	uniformCount.Update(commandCount);
+	glDispatchCompute((commandCount + groupSize - 1) / groupSize, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// add the visible instances to their commands
+	if (instanceCount > 0 && (!late || useHiZ)) {
+		uniformStage.Update(late ? 3 : 1);
+		uniformCount.Update(instanceCount);
+		glDispatchCompute((instanceCount + groupSize - 1) / groupSize, 1, 1);
+	}
+
+	// the geometry pass reads the commands as draw parameters and the instance ids in its vertex shader
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void ECullingPass::Initialize()
+{
+	if (cullShader == nullptr) {
+		cullShader = new Shader("..\\shaders\\Cull.comp");
+	}
+	_shader = cullShader;
+	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "VP", []() { return Game::Projection * Game::View; }));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "hiZ", EHiZPass::textureUnit));
+	uniformStage = EOGLUniform<int>(_shader, "stage", 0);
+	uniformCount = EOGLUniform<int>(_shader, "count", 0);
+	uniformHiZVP = EOGLUniform<mat4>(_shader, "hiZVP", mat4(1));
+	uniformHiZSize = EOGLUniform<vec2>(_shader, "hiZSize", vec2(1));
+	uniformUseHiZ = EOGLUniform<bool>(_shader, "useHiZ", false);
+
+	ERenderPass::Initialize();
+}
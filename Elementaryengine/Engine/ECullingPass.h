@@ -0,0 +1,32 @@
+#pragma once
+#include "ERenderPass.h"
+#include <EHiZPass.h>
+
+///<summary>
+///tests the bounding sphere of every instance against the view frustum on the GPU. The visible instances of each draw command are written
+///to the visible instance buffer, starting at the base instance of the command, and their count to the culled indirect buffer.
+///With a depth pyramid the early pass also rejects the instances hidden in the pyramid of the last frame, and the late pass, run after the
+///pyramid was rebuilt from the early draws, tests those again and writes the ones that became visible to the late indirect buffer
+///</summary>
+class ECullingPass :
+	public ERenderPass
+{
+public:
+	ECullingPass(EHiZPass* hiZ = nullptr, bool late = false);
+	~ECullingPass();
+
+	virtual void Render();
+	virtual void Initialize();
+
+private:
+	EHiZPass* hiZ;
+	bool late;
+	EOGLUniform<int> uniformStage;
+	EOGLUniform<int> uniformCount;
+	EOGLUniform<mat4> uniformHiZVP;
+	EOGLUniform<vec2> uniformHiZSize;
+	EOGLUniform<bool> uniformUseHiZ;
+	const int groupSize = 64;
+	// the early and the late pass share the program
+	static Shader* cullShader;
+};
@@ -77,6 +77,19 @@ EGeometryPass::EGeometryPass(OUT GLuint * positionBuffer, OUT GLuint * normalBuf
 
 
 
+EGeometryPass::EGeometryPass(EGeometryPass * target)
+{
+	// draws into the framebuffer of the target, the one ERenderPass created is not needed
+	glDeleteFramebuffers(1, &renderBuffer);
+	renderBuffer = target->renderBuffer;
+	PositionBuffer = target->PositionBuffer;
+	NormalBuffer = target->NormalBuffer;
+	AlbedoSpecBuffer = target->AlbedoSpecBuffer;
+	MaterialBuffer = target->MaterialBuffer;
+	DepthBuffer = target->DepthBuffer;
+	Clear = false;
+}
+
 EGeometryPass::~EGeometryPass()
 {
 }
@@ -93,8 +106,10 @@ void EGeometryPass::Render()
 	glClearColor(0.050f, 0.125f, 0.247f, 0);
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LESS);
-	glClear(GL_COLOR_BUFFER_BIT);
-	glClear(GL_DEPTH_BUFFER_BIT);
+	if (Clear) {
+		glClear(GL_COLOR_BUFFER_BIT);
+		glClear(GL_DEPTH_BUFFER_BIT);
+	}
 
 	//set viewport
 	glViewport(0, 0, displaySettings->windowWidth, displaySettings->windowHeight);
@@ -103,7 +118,7 @@ void EGeometryPass::Render()
 	// bind the composed mesh and its buffers
 	glBindVertexArray(eOpenGl->vao);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eOpenGl->gElementBuffer);
-	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, eOpenGl->gIndirectBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, IndirectBuffer != 0 ? IndirectBuffer : eOpenGl->gIndirectBuffer);
 
 	// bind the array of textures
 	glActiveTexture(GL_TEXTURE0);
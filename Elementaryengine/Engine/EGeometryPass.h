@@ -7,6 +7,10 @@ class EGeometryPass :
 public:
 	EGeometryPass();
 	EGeometryPass(OUT GLuint* positionBuffer, OUT GLuint* normalBuffer, OUT GLuint* albedoSpecBuffer, OUT GLuint* materialBuffer, OUT GLuint* deepthBuffer);
+	///<summary>
+	///draws on top of the buffers of the given pass without clearing them
+	///</summary>
+	EGeometryPass(EGeometryPass* target);
 	~EGeometryPass();
 
 	virtual void Render();
@@ -17,5 +21,10 @@ public:
 	GLuint AlbedoSpecBuffer;
 	GLuint MaterialBuffer;
 	GLuint DepthBuffer;
+
+	// the draw commands to draw, the full command buffer of EOpenGl if 0
+	GLuint IndirectBuffer = 0;
+	// clear the buffers before drawing
+	bool Clear = true;
 };
 
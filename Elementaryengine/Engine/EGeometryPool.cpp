@@ -0,0 +1,157 @@
+#include "EGeometryPool.h"
+#include <Mesh.h>
+
+int ERangeAllocator::Allocate(int count)
+{
+	if (count <= 0)
+		return -1;
+	for (auto range = freeRanges.begin(); range != freeRanges.end(); range++)
+	{
+		if (range->second < count)
+			continue;
+		int first = range->first;
+		int rest = range->second - count;
+		freeRanges.erase(range);
+		if (rest > 0) {
+			freeRanges[first + count] = rest;
+		}
+		used += count;
+		return first;
+	}
+	return -1;
+}
+
+void ERangeAllocator::Free(int first, int count)
+{
+	if (count <= 0)
+		return;
+	used -= count;
+	auto next = freeRanges.lower_bound(first);
+	// merge with the free range behind it
+	if (next != freeRanges.end() && next->first == first + count) {
+		count += next->second;
+		next = freeRanges.erase(next);
+	}
+	// and the one in front of it
+	if (next != freeRanges.begin()) {
+		auto previous = prev(next);
+		if (previous->first + previous->second == first) {
+			previous->second += count;
+			return;
+		}
+	}
+	freeRanges[first] = count;
+}
+
+void ERangeAllocator::Grow(int capacity)
+{
+	if (capacity <= this->capacity)
+		return;
+	int first = this->capacity;
+	int count = capacity - this->capacity;
+	this->capacity = capacity;
+	// Free takes it out of used again
+	used += count;
+	Free(first, count);
+}
+
+int ERangeAllocator::Capacity()
+{
+	return capacity;
+}
+
+int ERangeAllocator::Used()
+{
+	return used;
+}
+
+void EGeometryPool::Setup(GLuint vertexBuffer, GLuint indexBuffer, int vertexCapacity, int indexCapacity)
+{
+	this->vertexBuffer = vertexBuffer;
+	this->indexBuffer = indexBuffer;
+	// the copy targets leave the element buffer binding of the bound vertex array object alone
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCapacity * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCapacity * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	vertexRanges.Grow(vertexCapacity);
+	indexRanges.Grow(indexCapacity);
+}
+
+void EGeometryPool::Add(Mesh * m)
+{
+	if (m->poolVertexCount == (int)m->vertices.size() && m->poolIndexCount == (int)m->indices.size())
+		return;
+	Remove(m);
+	if (m->vertices.empty() || m->indices.empty())
+		return;
+
+	m->vertexOffset = allocate(vertexRanges, vertexBuffer, sizeof(Vertex), m->vertices.size());
+	m->poolVertexCount = m->vertices.size();
+	m->indexOffset = allocate(indexRanges, indexBuffer, sizeof(unsigned int), m->indices.size());
+	m->poolIndexCount = m->indices.size();
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m->vertexOffset * sizeof(Vertex), m->vertices.size() * sizeof(Vertex), m->vertices.data());
+	// the indices stay relative to the mesh, the draw command adds the vertex offset
+	glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m->indexOffset * sizeof(unsigned int), m->indices.size() * sizeof(unsigned int), m->indices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	m->verticesChanged = false;
+}
+
+void EGeometryPool::Remove(Mesh * m)
+{
+	if (m->poolVertexCount > 0) {
+		vertexRanges.Free(m->vertexOffset, m->poolVertexCount);
+	}
+	if (m->poolIndexCount > 0) {
+		indexRanges.Free(m->indexOffset, m->poolIndexCount);
+	}
+	m->vertexOffset = 0;
+	m->indexOffset = 0;
+	m->poolVertexCount = 0;
+	m->poolIndexCount = 0;
+}
+
+void EGeometryPool::UpdateVertices(Mesh * m)
+{
+	m->verticesChanged = false;
+	// a resized mesh moves with the next Add
+	if (m->poolVertexCount != (int)m->vertices.size())
+		return;
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)m->vertexOffset * sizeof(Vertex), m->vertices.size() * sizeof(Vertex), m->vertices.data());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+int EGeometryPool::allocate(ERangeAllocator & allocator, GLuint buffer, int elementSize, int count)
+{
+	int first = allocator.Allocate(count);
+	if (first >= 0)
+		return first;
+
+	// double the buffer, the new part alone always fits the range
+	int oldCapacity = allocator.Capacity();
+	int capacity = oldCapacity * 2;
+	if (capacity < oldCapacity + count) {
+		capacity = oldCapacity + count;
+	}
+
+	// a new store keeps the buffer name, the old content goes through a temporary buffer
+	GLuint temporary;
+	glGenBuffers(1, &temporary);
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, temporary);
+	glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)oldCapacity * elementSize, nullptr, GL_STREAM_COPY);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)oldCapacity * elementSize);
+	glBufferData(GL_COPY_READ_BUFFER, (GLsizeiptr)capacity * elementSize, nullptr, GL_DYNAMIC_DRAW);
+	glCopyBufferSubData(GL_COPY_WRITE_BUFFER, GL_COPY_READ_BUFFER, 0, 0, (GLsizeiptr)oldCapacity * elementSize);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glDeleteBuffers(1, &temporary);
+
+	allocator.Grow(capacity);
+	return allocator.Allocate(count);
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <EEngine.h>
+#include <map>
+
+using namespace std;
+
+class Mesh;
+
+///<summary>
+///first fit allocator over a range of elements, freed ranges merge with their neighbours
+///</summary>
+class ERangeAllocator
+{
+public:
+	///<returns>
+	///the first element of the range, -1 if no free range is big enough
+	///</returns>
+	int Allocate(int count);
+	void Free(int first, int count);
+	///<summary>
+	///adds the elements between the old and the new capacity as a free range
+	///</summary>
+	void Grow(int capacity);
+	int Capacity();
+	// elements in use
+	int Used();
+
+private:
+	// first element -> count
+	map<int, int> freeRanges;
+	int capacity = 0;
+	int used = 0;
+};
+
+///<summary>
+///vertex and index buffer shared by all meshes. Every mesh gets its own range in both, so adding, changing or removing a mesh only uploads that mesh
+///and freed ranges get reused. Full buffers double in size and keep their names, the vertex array object stays valid
+///</summary>
+class EGeometryPool
+{
+public:
+	void Setup(GLuint vertexBuffer, GLuint indexBuffer, int vertexCapacity = 1 << 16, int indexCapacity = 3 << 16);
+
+	///<summary>
+	///gives the mesh its ranges and uploads it. Meshes that already have ranges of their size are skipped, meshes that changed their size move
+	///</summary>
+	void Add(Mesh* m);
+
+	///<summary>
+	///frees the ranges of the mesh
+	///</summary>
+	void Remove(Mesh* m);
+
+	///<summary>
+	///uploads the vertices of the mesh into its range
+	///</summary>
+	void UpdateVertices(Mesh* m);
+
+private:
+	// allocates count elements, grows the buffer if needed
+	int allocate(ERangeAllocator& allocator, GLuint buffer, int elementSize, int count);
+
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer = 0;
+	ERangeAllocator vertexRanges;
+	ERangeAllocator indexRanges;
+};
@@ -0,0 +1,136 @@
+#include "EGlyphAtlas.h"
+#include <iostream>
+#include <algorithm>
+
+bool EGlyphAtlas::Initialize(const string & fontPath, unsigned int pixelSize, unsigned int size)
+{
+	Size = size;
+	glGenTextures(1, &Texture);
+	glBindTexture(GL_TEXTURE_2D, Texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, Size, Size);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	clear();
+
+	// the face stays open, glyphs are rasterized when they are first used
+	if (FT_Init_FreeType(&ft)) {
+		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+		return false;
+	}
+	if (FT_New_Face(ft, fontPath.c_str(), 0, &face)) {
+		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+		face = nullptr;
+		return false;
+	}
+	FT_Set_Pixel_Sizes(face, 0, pixelSize);
+	return true;
+}
+
+EGlyphAtlas::~EGlyphAtlas()
+{
+	if (face != nullptr) {
+		FT_Done_Face(face);
+	}
+	if (ft != nullptr) {
+		FT_Done_FreeType(ft);
+	}
+	if (Texture != 0) {
+		glDeleteTextures(1, &Texture);
+	}
+}
+
+Glyph EGlyphAtlas::Get(unsigned int codepoint)
+{
+	auto it = glyphs.find(codepoint);
+	if (it != glyphs.end()) {
+		return it->second;
+	}
+	Glyph glyph = { ivec2(0), ivec2(0), 0, vec4(0) };
+	if (!rasterize(codepoint, glyph)) {
+		// unknown glyphs aren't tried again, glyphs that didn't fit are when the atlas was cleared
+		if (full) {
+			return glyph;
+		}
+	}
+	glyphs[codepoint] = glyph;
+	return glyph;
+}
+
+void EGlyphAtlas::BeginFrame()
+{
+	if (full) {
+		clear();
+	}
+}
+
+unsigned int EGlyphAtlas::DecodeUTF8(const string & text, size_t & i)
+{
+	const unsigned int replacement = 0xFFFD;
+	unsigned char c = text[i++];
+	// the number of continuation bytes from the lead byte
+	int length = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+	if (length < 0) {
+		return replacement;
+	}
+	unsigned int codepoint = length == 0 ? c : c & (0x3F >> length);
+	for (int k = 0; k < length; k++)
+	{
+		if (i >= text.size() || ((unsigned char)text[i] & 0xC0) != 0x80) {
+			return replacement;
+		}
+		codepoint = (codepoint << 6) | ((unsigned char)text[i++] & 0x3F);
+	}
+	// the smallest code point of each length, smaller ones would fit a shorter sequence and are overlong
+	const unsigned int minimum[] = { 0, 0x80, 0x800, 0x10000 };
+	if (codepoint < minimum[length] || (codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF) {
+		return replacement;
+	}
+	return codepoint;
+}
+
+bool EGlyphAtlas::rasterize(unsigned int codepoint, Glyph & glyph)
+{
+	if (face == nullptr || FT_Load_Char(face, codepoint, FT_LOAD_RENDER)) {
+		return false;
+	}
+	FT_GlyphSlot slot = face->glyph;
+	int width = slot->bitmap.width;
+	int height = slot->bitmap.rows;
+	glyph.size = ivec2(width, height);
+	glyph.bearing = ivec2(slot->bitmap_left, slot->bitmap_top);
+	glyph.advance = (slot->advance.x >> 6); // Bitshift by 6 to get value in pixels (2^6 = 64)
+
+	// a texel of space between the glyphs so the linear filter doesn't read the neighbours
+	if (cursor.x + width + 1 > (int)Size) {
+		cursor = ivec2(0, cursor.y + rowHeight + 1);
+		rowHeight = 0;
+	}
+	if (cursor.y + height + 1 > (int)Size) {
+		full = true;
+		glyph.size = ivec2(0);
+		return false;
+	}
+	if (width > 0 && height > 0) {
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Disable byte-alignment restriction
+		glBindTexture(GL_TEXTURE_2D, Texture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, cursor.x, cursor.y, width, height, GL_RED, GL_UNSIGNED_BYTE, slot->bitmap.buffer);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+	glyph.uv = vec4(cursor, width, height) / (float)Size;
+	cursor.x += width + 1;
+	rowHeight = (std::max)(rowHeight, height);
+	return true;
+}
+
+void EGlyphAtlas::clear()
+{
+	glyphs.clear();
+	cursor = ivec2(0);
+	rowHeight = 0;
+	full = false;
+	unsigned char empty = 0;
+	glClearTexImage(Texture, 0, GL_RED, GL_UNSIGNED_BYTE, &empty);
+}
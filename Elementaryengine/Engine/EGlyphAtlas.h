@@ -0,0 +1,63 @@
+#pragma once
+#include <EEngine.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+using namespace glm;
+
+struct Glyph {
+	glm::ivec2 size;       // Size of glyph
+	glm::ivec2 bearing;    // Offset from baseline to left/top of glyph
+	GLfloat    advance;    // Offset to advance to next glyph in pixels
+	glm::vec4  uv;         // corner and size of the glyph in the atlas in texture coordinates
+};
+
+///<summary>
+///one texture with the glyphs of a font, rasterized with FreeType the first time they are used. The glyphs are packed in rows,
+///when the atlas runs full it is cleared at the start of the next frame and refilled with the glyphs still in use
+///</summary>
+class EGlyphAtlas
+{
+public:
+	///<summary>
+	///loads the font and creates the size x size atlas, false if the font couldn't be loaded
+	///</summary>
+	bool Initialize(const string& fontPath, unsigned int pixelSize, unsigned int size);
+	///<summary>
+	///closes the font and deletes the atlas texture
+	///</summary>
+	~EGlyphAtlas();
+
+	///<summary>
+	///the glyph of the unicode code point, rasterized into the atlas if it isn't in it yet. Glyphs that don't fit have no size
+	///</summary>
+	Glyph Get(unsigned int codepoint);
+
+	///<summary>
+	///clears the atlas if it ran full in the last frame, call before the glyphs of a frame are requested
+	///</summary>
+	void BeginFrame();
+
+	///<summary>
+	///the code point of the UTF-8 sequence at i in text, i is moved behind it. Invalid sequences, overlong encodings, surrogates and code points above U+10FFFF are U+FFFD
+	///</summary>
+	static unsigned int DecodeUTF8(const string& text, size_t& i);
+
+	GLuint Texture = 0;
+	unsigned int Size = 0;
+
+private:
+	bool rasterize(unsigned int codepoint, Glyph& glyph);
+	void clear();
+
+	FT_Library ft = nullptr;
+	FT_Face face = nullptr;
+	unordered_map<unsigned int, Glyph> glyphs;
+	// the next free position in the current row and the height of the row
+	ivec2 cursor = ivec2(0);
+	int rowHeight = 0;
+	bool full = false;
+};
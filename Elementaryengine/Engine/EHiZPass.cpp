@@ -0,0 +1,76 @@
+#include "EHiZPass.h"
+#include <Game.h>
+
+EHiZPass::EHiZPass(GLuint depthBuffer, bool closest)
+{
+	DepthBuffer = depthBuffer;
+	Closest = closest;
+}
+
+
+EHiZPass::~EHiZPass()
+{
+}
+
+void EHiZPass::Render()
+{
+	ERenderPass::Render();
+
+	// level 0 is a copy of the depth buffer
+	glActiveTexture(GL_TEXTURE0 + textureUnit);
+	glBindTexture(GL_TEXTURE_2D, DepthBuffer);
+	glBindSampler(textureUnit, depthSampler);
+	uniformStage.Update(0);
+	glBindImageTexture(0, Pyramid, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	glDispatchCompute((Width + 7) / 8, (Height + 7) / 8, 1);
+	glBindSampler(textureUnit, 0);
+
+	// every further level is the max of the one below
+	uniformStage.Update(1);
+	for (int level = 1; level < Levels; level++)
+	{
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		int width = (std::max)(1, Width >> level);
+		int height = (std::max)(1, Height >> level);
+		glBindImageTexture(0, Pyramid, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glBindImageTexture(1, Pyramid, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+	}
+
+	// the culling pass fetches the pyramid as a texture
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glActiveTexture(GL_TEXTURE0);
+	ViewProjection = Game::Projection * Game::View;
+	Valid = true;
+}
+
+void EHiZPass::Initialize()
+{
+	_shader = new Shader("..\\shaders\\HiZ.comp");
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "depth", textureUnit));
+	_uniforms.push_back(new EOGLUniform<bool>(_shader, "closest", Closest));
+	uniformStage = EOGLUniform<int>(_shader, "stage", 0);
+	ERenderPass::Initialize();
+
+	// same size as the depth buffer, down to 1x1
+	Width = displaySettings->windowWidth;
+	Height = displaySettings->windowHeight;
+	Levels = 1;
+	while ((std::max)(Width, Height) >> Levels > 0)
+	{
+		Levels++;
+	}
+	glGenTextures(1, &Pyramid);
+	glBindTexture(GL_TEXTURE_2D, Pyramid);
+	glTexStorage2D(GL_TEXTURE_2D, Levels, GL_R32F, Width, Height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenSamplers(1, &depthSampler);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glSamplerParameteri(depthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "ERenderPass.h"
+
+///<summary>
+///builds the hierarchical depth pyramid of the geometry pass depth. Every level holds the farthest depth of the texels it covers,
+///so an object whose closest depth is behind one texel of the level of its screen size is hidden. A closest pyramid holds the closest
+///depth instead, a ray in front of a texel misses everything it covers
+///</summary>
+class EHiZPass :
+	public ERenderPass
+{
+public:
+	EHiZPass(GLuint depthBuffer, bool closest = false);
+	~EHiZPass();
+
+	virtual void Render();
+	virtual void Initialize();
+
+	GLuint DepthBuffer;
+	// reduce to the closest depth, for tracing rays, instead of the farthest one for occlusion culling
+	bool Closest;
+	// r32f texture with the full mip chain
+	GLuint Pyramid;
+	int Levels;
+	int Width;
+	int Height;
+	// the view projection the pyramid was rendered with
+	mat4 ViewProjection;
+	// false until the first pyramid is built
+	bool Valid = false;
+
+	// texture unit the pyramid and the depth buffer are bound to, clear of the units the passes use
+	static const int textureUnit = 10;
+
+private:
+	EOGLUniform<int> uniformStage;
+	// samples the depth buffer without its depth compare
+	GLuint depthSampler;
+};
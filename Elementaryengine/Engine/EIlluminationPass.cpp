@@ -67,6 +67,12 @@ void EIlluminationPass::Render()
 
 	SetupLamps(Game::eOpenGl, _shader);
 
+	// the light lists are built from the lamps just written, then the lighting shader is bound again
+	if (ClusteredLighting) {
+		clusters.Build((int)Game::lamps.size());
+		_shader->use();
+	}
+
 	Game::eOpenGl->renderQuad();
 }
 
@@ -85,18 +91,19 @@ void EIlluminationPass::Initialize()
 	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "invView", []() {return inverse(Game::View); }));
 	_uniforms.push_back(new EOGLUniform<float>(_shader, "far_plane", 25.0f));
 	_uniforms.push_back(new EOGLUniform<int>(_shader, "shadowMaps", 8));
+	_uniforms.push_back(new EOGLUniform<vec3>(_shader, "directionalLightDirection", []() {return Game::directionalLightDirection; }));
+	_uniforms.push_back(new EOGLUniform<vec3>(_shader, "directionalLightColor", []() {return Game::directionalLightColor; }));
 
 	ERenderPass::Initialize();
 
+	if (ClusteredLighting) {
+		clusters.Initialize();
+	}
+
 	//Setup framebuffer
 	glGenFramebuffers(1, &renderBuffer);
 	glBindFramebuffer(GL_FRAMEBUFFER, renderBuffer);
 
-	glGenBuffers(1, &lightColorSSBO);
-	glGenBuffers(1, &lightPositionSSBO);
-	glGenBuffers(1, &meshDataSSBO);
-	glGenBuffers(1, &uiElementsSSBO);
-	glGenBuffers(1, &drawIdOffsetBuffer);
 }
 
 void EIlluminationPass::SetupLamps(EOpenGl * eOpenGl, Shader * shader)
@@ -104,32 +111,31 @@ void EIlluminationPass::SetupLamps(EOpenGl * eOpenGl, Shader * shader)
 	// create vectors for light colors and positions
 	vector<vec4> lightColors;
 	vector<vec4> lightPositions;
+	vector<vec4> lightDirections;
 
-	// add color and position for each light to vectors
+	// add color, position and cone for each light to vectors
 	for each (Lamp* l in Game::lamps) {
 		vec3 outcol = l->color;
 		vec3 outpos = l->parents[0]->position;
 		lightColors.push_back(vec4(outcol, 0));
-		lightPositions.push_back(vec4(outpos, 0));
+		lightPositions.push_back(vec4(outpos, l->radius));
+		lightDirections.push_back(l->getCone());
 	}
 
 	// dont do this for the ssr shader
 	if (shader != Mesh::ssrShader) {
-		// bind Shadowmap texture array and set its uniform
+		// bind the shadow atlas
 		glActiveTexture(GL_TEXTURE8);
-		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, Game::eOpenGl->shadowMaps);
+		glBindTexture(GL_TEXTURE_2D, Game::eOpenGl->shadowMaps);
 	}
 
 
 	// copy color SSBO
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightColorSSBO);
-	GLsizeiptr lcs = sizeof(glm::vec4) * (lightColors.size());
-	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, lightColorSSBO, 0, lcs);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, lcs, lightColors.data(), GL_DYNAMIC_DRAW);
+	eOpenGl->lightColorSSBO.Write(lightColors.data(), sizeof(glm::vec4) * lightColors.size(), 3);
 
 	// copy position SSBO
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightPositionSSBO);
-	GLsizeiptr lps = sizeof(glm::vec4) * lightPositions.size();
-	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, lightPositionSSBO, 0, lps);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, lps, lightPositions.data(), GL_DYNAMIC_DRAW);
+	eOpenGl->lightPositionSSBO.Write(lightPositions.data(), sizeof(glm::vec4) * lightPositions.size(), 4);
+
+	// copy cone SSBO
+	eOpenGl->lightDirectionSSBO.Write(lightDirections.data(), sizeof(glm::vec4) * lightDirections.size(), 19);
 }
\ No newline at end of file
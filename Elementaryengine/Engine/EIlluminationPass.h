@@ -1,5 +1,6 @@
 #pragma once
 #include "ERenderPass.h"
+#include <ELightClusters.h>
 class EIlluminationPass :
 	public ERenderPass
 {
@@ -17,16 +18,15 @@ public:
 	GLuint MaterialBuffer;
 	GLuint DepthBuffer;
 
-	GLuint lightColorSSBO;
-	GLuint lightPositionSSBO;
-	GLuint meshDataSSBO;
-	GLuint uiElementsSSBO;
-	GLuint drawIdOffsetBuffer;
-
 	GLuint frameOut;
 
+	// shade only the lamps in the cluster of a pixel, needs the clusteredLighting shader define
+	bool ClusteredLighting = false;
+
 private:
 	void EIlluminationPass::SetupLamps(EOpenGl * eOpenGl, Shader * shader);
 
+	ELightClusters clusters;
+
 };
 
@@ -13,6 +13,11 @@ JsValueRef EJSFunction::JSAssetPrototype;
 JsValueRef EJSFunction::JSUIPrototype;
 JsValueRef EJSFunction::JSRaycastHitPrototype;
 JsValueRef EJSFunction::JSCameraPrototype;
+JsValueRef EJSFunction::JSCollisionEventPrototype;
+JsValueRef EJSFunction::JSTriggerVolumePrototype;
+JsValueRef EJSFunction::JSPhysicsSnapshotPrototype;
+JsValueRef EJSFunction::JSSoftBodyPrototype;
+JsValueRef EJSFunction::JSLampPrototype;
 
 
 vec3 EJSFunction::JSToNativeVec3(JsValueRef jsVec3)
@@ -71,6 +76,55 @@ Camera * EJSFunction::JSToNativeCamera(JsValueRef jsCamera)
 	return reinterpret_cast<Camera*>(p);
 }
 
+ECollisionEvent * EJSFunction::JSToNativeCollisionEvent(JsValueRef jsCollisionEvent)
+{
+	void* p;
+	JsGetExternalData(jsCollisionEvent, &p);
+	return reinterpret_cast<ECollisionEvent*>(p);
+}
+
+ETriggerVolume * EJSFunction::JSToNativeTriggerVolume(JsValueRef jsTrigger)
+{
+	void* p;
+	JsGetExternalData(jsTrigger, &p);
+	return reinterpret_cast<ETriggerVolume*>(p);
+}
+
+string EJSFunction::JSToNativeString(JsValueRef jsString)
+{
+	const wchar_t* p;
+	size_t length;
+	if (JsStringToPointer(jsString, &p, &length) != JsNoError)
+		return "";
+	wstring ws(p, length);
+	return string(ws.begin(), ws.end());
+}
+
+// layers can be given by name or by number, unknown names create a new layer
+int EJSFunction::JSToNativeLayer(JsValueRef jsLayer)
+{
+	JsValueType type;
+	JsGetValueType(jsLayer, &type);
+	if (type == JsString) {
+		return ECollisionLayers::Add(JSToNativeString(jsLayer));
+	}
+	int layer = -1;
+	JsNumberToInt(jsLayer, &layer);
+	return layer;
+}
+
+// collision events are created every frame, so the script owns its copies
+void EJSFunction::JSFinalizeCollisionEvent(void * data)
+{
+	delete static_cast<ECollisionEvent*>(data);
+}
+
+// snapshots are only referenced by the script
+void EJSFunction::JSFinalizePhysicsSnapshot(void * data)
+{
+	delete static_cast<EPhysicsSnapshot*>(data);
+}
+
 // new Vec3(number x, number y, number z)
 JsValueRef EJSFunction::JSConstructorVec3(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
 {
@@ -1189,6 +1243,138 @@ JsValueRef EJSFunction::JSAssetEqual(JsValueRef callee, bool isConstructCall, Js
 	return output;
 }
 
+JsValueRef EJSFunction::JSConstructorCollisionEvent(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+
+	ECollisionEvent* e = new ECollisionEvent();
+
+	JsCreateExternalObject(e, JSFinalizeCollisionEvent, &output);
+	JsSetPrototype(output, JSCollisionEventPrototype);
+	return output;
+}
+
+// asset.setCollisionEvents(int mask) 1: begin, 2: persist, 4: end
+JsValueRef EJSFunction::JSAssetSetCollisionEvents(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		Asset* element = JSToNativeAsset(arguments[0]);
+		int mask;
+		JsNumberToInt(arguments[1], &mask);
+		element->setCollisionEvents(mask);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// asset.setCollisionLayer(string name | int layer)
+JsValueRef EJSFunction::JSAssetSetCollisionLayer(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError && argumentCount > 1) {
+		Asset* element = JSToNativeAsset(arguments[0]);
+		int layer = JSToNativeLayer(arguments[1]);
+		if (layer >= 0) {
+			element->setCollisionLayer(layer);
+			noError = true;
+		}
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+JsValueRef EJSFunction::JSAssetGetCollisionLayer(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		Asset* element = JSToNativeAsset(arguments[0]);
+		JsIntToNumber(element->getCollisionLayer(), &output);
+	}
+	return output;
+}
+
+// collisionEvent.getType() 1: begin, 2: persist, 4: end
+JsValueRef EJSFunction::JSCollisionEventGetType(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* e;
+	if (JsGetExternalData(arguments[0], &e) == JsNoError) {
+		ECollisionEvent* element = static_cast<ECollisionEvent*>(e);
+		JsIntToNumber(element->type, &output);
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSCollisionEventGetAssetA(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* e;
+	if (JsGetExternalData(arguments[0], &e) == JsNoError) {
+		ECollisionEvent* element = static_cast<ECollisionEvent*>(e);
+		JsCreateExternalObject(element->assetA, nullptr, &output);
+		JsSetPrototype(output, JSAssetPrototype);
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSCollisionEventGetAssetB(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* e;
+	if (JsGetExternalData(arguments[0], &e) == JsNoError) {
+		ECollisionEvent* element = static_cast<ECollisionEvent*>(e);
+		JsCreateExternalObject(element->assetB, nullptr, &output);
+		JsSetPrototype(output, JSAssetPrototype);
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSCollisionEventGetPoint(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* e;
+	if (JsGetExternalData(arguments[0], &e) == JsNoError) {
+		ECollisionEvent* element = static_cast<ECollisionEvent*>(e);
+		vec3* val = new vec3();
+		*val = element->point;
+		JsCreateExternalObject(val, nullptr, &output);
+		JsSetPrototype(output, JSVec3Prototype);
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSCollisionEventGetNormal(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* e;
+	if (JsGetExternalData(arguments[0], &e) == JsNoError) {
+		ECollisionEvent* element = static_cast<ECollisionEvent*>(e);
+		vec3* val = new vec3();
+		*val = element->normal;
+		JsCreateExternalObject(val, nullptr, &output);
+		JsSetPrototype(output, JSVec3Prototype);
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSCollisionEventGetImpulse(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* e;
+	if (JsGetExternalData(arguments[0], &e) == JsNoError) {
+		ECollisionEvent* element = static_cast<ECollisionEvent*>(e);
+		JsDoubleToNumber(element->impulse, &output);
+	}
+	return output;
+}
+
 JsValueRef EJSFunction::JSCameraGetPosition(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
 {
 	JsValueRef output = JS_INVALID_REFERENCE;
@@ -1307,7 +1493,12 @@ JsValueRef EJSFunction::JSRaycast(JsValueRef callee, bool isConstructCall, JsVal
 	start = JSToNativeVec3(arguments[1]);
 	end = JSToNativeVec3(arguments[2]);
 
-	RayCastHit r = Game::Instance().Raycast(start, end);
+	int layerMask = ECollisionLayers::allLayers;
+	if (argumentCount > 3) {
+		JsNumberToInt(arguments[3], &layerMask);
+	}
+
+	RayCastHit r = Game::Instance().Raycast(start, end, layerMask);
 	if (r.hitAsset != nullptr) {
 		RayCastHit* val = new RayCastHit();
 		val->hitPos = r.hitPos;
@@ -1333,6 +1524,41 @@ JsValueRef EJSFunction::JSGetActiveCam(JsValueRef callee, bool isConstructCall,
 	return output;
 }
 
+// game.getLayerMask(string | int layer, ...) mask of all given layers
+JsValueRef EJSFunction::JSGetLayerMask(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	int mask = 0;
+	for (unsigned short i = 1; i < argumentCount; i++)
+	{
+		JsValueType type;
+		JsGetValueType(arguments[i], &type);
+		int layer = type == JsString ? ECollisionLayers::Get(JSToNativeString(arguments[i])) : JSToNativeLayer(arguments[i]);
+		mask |= ECollisionLayers::Group(layer);
+	}
+	JsIntToNumber(mask, &output);
+	return output;
+}
+
+// game.setLayersCollide(string | int layerA, string | int layerB, bool collide)
+JsValueRef EJSFunction::JSSetLayersCollide(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	if (argumentCount > 3) {
+		int layerA = JSToNativeLayer(arguments[1]);
+		int layerB = JSToNativeLayer(arguments[2]);
+		bool collide;
+		JsBooleanToBool(arguments[3], &collide);
+		if (layerA >= 0 && layerB >= 0) {
+			ECollisionLayers::SetCollides(layerA, layerB, collide);
+			noError = true;
+		}
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
 JsValueRef EJSFunction::JSRaycastGetHitPos(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
 {
 	JsValueRef output = JS_INVALID_REFERENCE;
@@ -1372,3 +1598,544 @@ JsValueRef EJSFunction::JSRaycastGetHitAsset(JsValueRef callee, bool isConstruct
 	}
 	return output;
 }
+
+static JsValueRef NativeToJSAssetArray(const vector<Asset*>& assets)
+{
+	JsValueRef output;
+	JsCreateArray((unsigned int)assets.size(), &output);
+	for (unsigned int i = 0; i < assets.size(); i++)
+	{
+		JsValueRef index, jsAsset;
+		JsIntToNumber(i, &index);
+		JsCreateExternalObject(assets[i], nullptr, &jsAsset);
+		JsSetPrototype(jsAsset, EJSFunction::JSAssetPrototype);
+		JsSetIndexedProperty(output, index, jsAsset);
+	}
+	return output;
+}
+
+// a RaycastResult for a hit, false otherwise
+static JsValueRef NativeToJSHit(const RayCastHit& hit)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	if (hit.hitAsset != nullptr) {
+		RayCastHit* val = new RayCastHit(hit);
+		JsCreateExternalObject(val, nullptr, &output);
+		JsSetPrototype(output, EJSFunction::JSRaycastHitPrototype);
+	}
+	else {
+		JsBoolToBoolean(false, &output);
+	}
+	return output;
+}
+
+static int OptionalLayerMask(JsValueRef * arguments, unsigned short argumentCount, unsigned short index)
+{
+	int layerMask = ECollisionLayers::allLayers;
+	if (argumentCount > index) {
+		JsNumberToInt(arguments[index], &layerMask);
+	}
+	return layerMask;
+}
+
+// new TriggerVolume(vec3 position, number radius | vec3 halfExtents, [int layerMask])
+JsValueRef EJSFunction::JSConstructorTriggerVolume(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	assert(isConstructCall && argumentCount > 2);
+	JsValueRef output = JS_INVALID_REFERENCE;
+
+	vec3 position = JSToNativeVec3(arguments[1]);
+	int layerMask = OptionalLayerMask(arguments, argumentCount, 3);
+	JsValueType sizeType;
+	JsGetValueType(arguments[2], &sizeType);
+	ETriggerVolume* trigger;
+	if (sizeType == JsNumber) {
+		double radius;
+		JsNumberToDouble(arguments[2], &radius);
+		trigger = new ETriggerVolume(position, (float)radius, layerMask);
+	}
+	else {
+		trigger = new ETriggerVolume(position, JSToNativeVec3(arguments[2]), layerMask);
+	}
+
+	JsCreateExternalObject(trigger, nullptr, &output);
+	JsSetPrototype(output, JSTriggerVolumePrototype);
+	return output;
+}
+
+JsValueRef EJSFunction::JSTriggerVolumeGetPosition(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		ETriggerVolume* element = JSToNativeTriggerVolume(arguments[0]);
+		vec3* val = new vec3();
+		*val = element->getPosition();
+		JsCreateExternalObject(val, nullptr, &output);
+		JsSetPrototype(output, JSVec3Prototype);
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSTriggerVolumeSetPosition(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		ETriggerVolume* element = JSToNativeTriggerVolume(arguments[0]);
+		element->setPosition(JSToNativeVec3(arguments[1]));
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// trigger.getOverlapping() array of the assets inside
+JsValueRef EJSFunction::JSTriggerVolumeGetOverlapping(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		ETriggerVolume* element = JSToNativeTriggerVolume(arguments[0]);
+		output = NativeToJSAssetArray(element->getOverlapping());
+	}
+	return output;
+}
+
+JsValueRef EJSFunction::JSTriggerVolumeDelete(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		ETriggerVolume* element = JSToNativeTriggerVolume(arguments[0]);
+		element->Destroy();
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+JsValueRef EJSFunction::JSTriggerVolumeEqual(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool equal = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		ETriggerVolume* t1 = JSToNativeTriggerVolume(arguments[0]);
+		ETriggerVolume* t2 = JSToNativeTriggerVolume(arguments[1]);
+		equal = (t1 == t2);
+	}
+	JsBoolToBoolean(equal, &output);
+	return output;
+}
+
+// game.overlapSphere(vec3 center, number radius, [int layerMask]) array of the assets inside
+JsValueRef EJSFunction::JSOverlapSphere(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	vec3 center = JSToNativeVec3(arguments[1]);
+	double radius;
+	JsNumberToDouble(arguments[2], &radius);
+	return NativeToJSAssetArray(EPhysicsQueries::OverlapSphere(center, (float)radius, OptionalLayerMask(arguments, argumentCount, 3)));
+}
+
+// game.overlapBox(vec3 center, vec3 halfExtents, [int layerMask]) array of the assets inside the axis aligned box
+JsValueRef EJSFunction::JSOverlapBox(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	vec3 center = JSToNativeVec3(arguments[1]);
+	vec3 halfExtents = JSToNativeVec3(arguments[2]);
+	return NativeToJSAssetArray(EPhysicsQueries::OverlapBox(center, halfExtents, quat(1, 0, 0, 0), OptionalLayerMask(arguments, argumentCount, 3)));
+}
+
+// game.overlapSpheres(vec3[] centers, number radius, [int layerMask]) one array of assets per center, the spheres are tested in parallel
+JsValueRef EJSFunction::JSOverlapSpheres(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	double radius;
+	JsNumberToDouble(arguments[2], &radius);
+	int layerMask = OptionalLayerMask(arguments, argumentCount, 3);
+
+	JsPropertyIdRef lengthId;
+	JsValueRef jsLength;
+	int length = 0;
+	JsGetPropertyIdFromName(L"length", &lengthId);
+	JsGetProperty(arguments[1], lengthId, &jsLength);
+	JsNumberToInt(jsLength, &length);
+
+	vector<EShapeQuery> queries(length);
+	for (int i = 0; i < length; i++)
+	{
+		JsValueRef index, jsCenter;
+		JsIntToNumber(i, &index);
+		JsGetIndexedProperty(arguments[1], index, &jsCenter);
+		queries[i].shape = querySphere;
+		queries[i].position = JSToNativeVec3(jsCenter);
+		queries[i].radius = (float)radius;
+		queries[i].layerMask = layerMask;
+	}
+	vector<vector<Asset*>> results = EPhysicsQueries::OverlapBatch(queries);
+
+	JsCreateArray(length, &output);
+	for (int i = 0; i < length; i++)
+	{
+		JsValueRef index;
+		JsIntToNumber(i, &index);
+		JsSetIndexedProperty(output, index, NativeToJSAssetArray(results[i]));
+	}
+	return output;
+}
+
+// game.sweepSphere(vec3 start, vec3 end, number radius, [int layerMask]) RaycastResult of the first hit or false
+JsValueRef EJSFunction::JSSweepSphere(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	vec3 start = JSToNativeVec3(arguments[1]);
+	vec3 end = JSToNativeVec3(arguments[2]);
+	double radius;
+	JsNumberToDouble(arguments[3], &radius);
+	return NativeToJSHit(EPhysicsQueries::SweepSphere(start, end, (float)radius, OptionalLayerMask(arguments, argumentCount, 4)));
+}
+
+// game.sweepBox(vec3 start, vec3 end, vec3 halfExtents, [int layerMask]) RaycastResult of the first hit or false
+JsValueRef EJSFunction::JSSweepBox(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	vec3 start = JSToNativeVec3(arguments[1]);
+	vec3 end = JSToNativeVec3(arguments[2]);
+	vec3 halfExtents = JSToNativeVec3(arguments[3]);
+	return NativeToJSHit(EPhysicsQueries::SweepBox(start, end, halfExtents, quat(1, 0, 0, 0), OptionalLayerMask(arguments, argumentCount, 4)));
+}
+
+// new PhysicsSnapshot() captures the current state of the physics world
+JsValueRef EJSFunction::JSConstructorPhysicsSnapshot(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+
+	EPhysicsSnapshot* snapshot = new EPhysicsSnapshot();
+	snapshot->Capture();
+
+	JsCreateExternalObject(snapshot, JSFinalizePhysicsSnapshot, &output);
+	JsSetPrototype(output, JSPhysicsSnapshotPrototype);
+	return output;
+}
+
+JsValueRef EJSFunction::JSPhysicsSnapshotRestore(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* snapshot;
+	if (JsGetExternalData(arguments[0], &snapshot) == JsNoError) {
+		static_cast<EPhysicsSnapshot*>(snapshot)->Restore();
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// game.capturePhysics() same as new PhysicsSnapshot()
+JsValueRef EJSFunction::JSCapturePhysics(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	return JSConstructorPhysicsSnapshot(callee, false, arguments, argumentCount, callbackState);
+}
+
+// game.setFixedTimestep(number seconds) 0 to step with the elapsed time again
+JsValueRef EJSFunction::JSSetFixedTimestep(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	double timeStep;
+	JsNumberToDouble(arguments[1], &timeStep);
+	Game::fixedTimeStep = timeStep;
+	JsBoolToBoolean(true, &output);
+	return output;
+}
+
+// game.verifyPhysicsReplay(int steps) true if replaying the next steps from a snapshot is bit identical
+JsValueRef EJSFunction::JSVerifyPhysicsReplay(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	int steps = 60;
+	if (argumentCount > 1) {
+		JsNumberToInt(arguments[1], &steps);
+	}
+	double timeStep = Game::fixedTimeStep;
+	if (timeStep <= 0) {
+		timeStep = 1.0 / 60.0;
+	}
+	bool replayed = EPhysicsSnapshot::VerifyReplay(steps, (btScalar)timeStep);
+	Game::console.Print(replayed ? "physics replay is bit identical" : "physics replay diverged");
+	JsBoolToBoolean(replayed, &output);
+	return output;
+}
+
+// asset.setCcd(number motionThreshold, number sweptSphereRadius) or asset.setCcd() to derive them from the shape again
+JsValueRef EJSFunction::JSAssetSetCcd(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		Asset* element = JSToNativeAsset(arguments[0]);
+		if (argumentCount > 2) {
+			double motionThreshold, sweptSphereRadius;
+			JsNumberToDouble(arguments[1], &motionThreshold);
+			JsNumberToDouble(arguments[2], &sweptSphereRadius);
+			element->setCcd((float)motionThreshold, (float)sweptSphereRadius);
+		}
+		else {
+			element->setCcdAuto();
+		}
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+JsValueRef EJSFunction::JSAssetSetCcdEnabled(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* uie;
+	if (JsGetExternalData(arguments[0], &uie) == JsNoError) {
+		Asset* element = JSToNativeAsset(arguments[0]);
+		bool enabled;
+		JsBooleanToBool(arguments[1], &enabled);
+		element->setCcdEnabled(enabled);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// game.setCcdSpeedThreshold(number speed) bodies slower than this never use continuous collision
+JsValueRef EJSFunction::JSSetCcdSpeedThreshold(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	double speed;
+	JsNumberToDouble(arguments[1], &speed);
+	EContinuousCollision::speedThreshold = (float)speed;
+	JsBoolToBoolean(true, &output);
+	return output;
+}
+
+// game.bakePhysics(string path) writes the bodies of the scene and their collision shapes to a .bullet file, see Game::physicsBakeFile
+JsValueRef EJSFunction::JSBakePhysics(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool baked = false;
+	if (argumentCount > 1) {
+		baked = EPhysicsBake::Bake(JSToNativeString(arguments[1]));
+	}
+	JsBoolToBoolean(baked, &output);
+	return output;
+}
+
+// ----------------------------------------------------------------------------
+// SOFTBODY CONSTRUCTOR AND MEMBER FUNCTIONS
+// ----------------------------------------------------------------------------
+
+// new SoftBody(Asset asset, Mesh mesh, string type = "cloth", number mass = 1) type is "cloth", "rope" or "volume". The body stays until softBody.destroy() or until the asset is destroyed
+JsValueRef EJSFunction::JSConstructorSoftBody(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	assert(isConstructCall && argumentCount > 2);
+	JsValueRef output = JS_INVALID_REFERENCE;
+
+	ESoftBodySettings settings;
+	if (argumentCount > 3) {
+		string type = JSToNativeString(arguments[3]);
+		if (type == "rope") {
+			settings.type = softRope;
+		}
+		else if (type == "volume") {
+			settings.type = softVolume;
+		}
+	}
+	if (argumentCount > 4) {
+		double mass;
+		JsNumberToDouble(arguments[4], &mass);
+		settings.mass = (float)mass;
+	}
+	ESoftBody* softBody = new ESoftBody(JSToNativeAsset(arguments[1]), JSToNativeMesh(arguments[2]), settings);
+
+	JsCreateExternalObject(softBody, nullptr, &output);
+	JsSetPrototype(output, JSSoftBodyPrototype);
+	return output;
+}
+
+// softBody.pin(Vec3 point, number radius)
+JsValueRef EJSFunction::JSSoftBodyPin(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* softBody;
+	if (JsGetExternalData(arguments[0], &softBody) == JsNoError && softBody != nullptr) {
+		double radius;
+		JsNumberToDouble(arguments[2], &radius);
+		static_cast<ESoftBody*>(softBody)->pin(JSToNativeVec3(arguments[1]), (float)radius);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// softBody.anchor(Asset asset, Vec3 point, number radius)
+JsValueRef EJSFunction::JSSoftBodyAnchor(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* softBody;
+	if (JsGetExternalData(arguments[0], &softBody) == JsNoError && softBody != nullptr) {
+		double radius;
+		JsNumberToDouble(arguments[3], &radius);
+		static_cast<ESoftBody*>(softBody)->anchor(JSToNativeAsset(arguments[1]), JSToNativeVec3(arguments[2]), (float)radius);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// softBody.addForce(Vec3 force)
+JsValueRef EJSFunction::JSSoftBodyAddForce(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* softBody;
+	if (JsGetExternalData(arguments[0], &softBody) == JsNoError && softBody != nullptr) {
+		static_cast<ESoftBody*>(softBody)->addForce(JSToNativeVec3(arguments[1]));
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// softBody.destroy() removes the body from the world and its mesh from the asset
+JsValueRef EJSFunction::JSSoftBodyDelete(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* softBody;
+	if (JsGetExternalData(arguments[0], &softBody) == JsNoError && softBody != nullptr) {
+		delete static_cast<ESoftBody*>(softBody);
+		// later calls on the object do nothing
+		JsSetExternalData(arguments[0], nullptr);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// ----------------------------------------------------------------------------
+// LAMP CONSTRUCTOR AND MEMBER FUNCTIONS
+// ----------------------------------------------------------------------------
+
+// new Lamp(Asset asset) point lamp at the position of the asset
+JsValueRef EJSFunction::JSConstructorLamp(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	assert(isConstructCall && argumentCount > 1);
+	JsValueRef output = JS_INVALID_REFERENCE;
+
+	Lamp* lamp = new Lamp();
+	lamp->attachTo(JSToNativeAsset(arguments[1]));
+
+	JsCreateExternalObject(lamp, nullptr, &output);
+	JsSetPrototype(output, JSLampPrototype);
+	return output;
+}
+
+// lamp.setType(string type) "point" or "spot"
+JsValueRef EJSFunction::JSLampSetType(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		string type = JSToNativeString(arguments[1]);
+		if (type == "point" || type == "spot") {
+			static_cast<Lamp*>(lamp)->type = type == "spot" ? spotLamp : pointLamp;
+			noError = true;
+		}
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// lamp.getType() "point" or "spot"
+JsValueRef EJSFunction::JSLampGetType(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		const wchar_t* type = static_cast<Lamp*>(lamp)->type == spotLamp ? L"spot" : L"point";
+		JsPointerToString(type, wcslen(type), &output);
+	}
+	return output;
+}
+
+// lamp.setSpotAngle(number degrees) half the opening angle of the cone, clamped to 1 - 89
+JsValueRef EJSFunction::JSLampSetSpotAngle(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		double angle;
+		JsNumberToDouble(arguments[1], &angle);
+		static_cast<Lamp*>(lamp)->setSpotAngle((float)angle);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// lamp.getSpotAngle() half the opening angle of the cone in degrees
+JsValueRef EJSFunction::JSLampGetSpotAngle(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		JsDoubleToNumber(static_cast<Lamp*>(lamp)->getSpotAngle(), &output);
+	}
+	return output;
+}
+
+// lamp.setRadius(number range) the distance at which the light has faded out, at least 0.01
+JsValueRef EJSFunction::JSLampSetRadius(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		double range;
+		JsNumberToDouble(arguments[1], &range);
+		static_cast<Lamp*>(lamp)->setRadius((float)range);
+		noError = true;
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
+
+// lamp.getRadius()
+JsValueRef EJSFunction::JSLampGetRadius(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		JsDoubleToNumber(static_cast<Lamp*>(lamp)->getRadius(), &output);
+	}
+	return output;
+}
+
+// lamp.setDirection(Vec3 direction) the axis of the cone of a spot lamp
+JsValueRef EJSFunction::JSLampSetDirection(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState)
+{
+	JsValueRef output = JS_INVALID_REFERENCE;
+	bool noError = false;
+	void* lamp;
+	if (JsGetExternalData(arguments[0], &lamp) == JsNoError) {
+		vec3 direction = JSToNativeVec3(arguments[1]);
+		if (length(direction) > 0) {
+			static_cast<Lamp*>(lamp)->Direction = direction;
+			noError = true;
+		}
+	}
+	JsBoolToBoolean(noError, &output);
+	return output;
+}
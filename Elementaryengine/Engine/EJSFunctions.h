@@ -10,6 +10,11 @@
 #include <UIElement.h>
 #include <RayCastHit.h>
 #include <Camera.h>
+#include <ECollisionEvents.h>
+#include <ETriggerVolume.h>
+#include <EPhysicsQueries.h>
+#include <ESoftBody.h>
+#include <Lamp.h>
 
 namespace EJSFunction {
 
@@ -22,6 +27,11 @@ namespace EJSFunction {
 	extern JsValueRef JSUIPrototype;
 	extern JsValueRef JSRaycastHitPrototype;
 	extern JsValueRef JSCameraPrototype;
+	extern JsValueRef JSCollisionEventPrototype;
+	extern JsValueRef JSTriggerVolumePrototype;
+	extern JsValueRef JSPhysicsSnapshotPrototype;
+	extern JsValueRef JSSoftBodyPrototype;
+	extern JsValueRef JSLampPrototype;
 
 	// Javascript to Native object conversion
 	vec3 JSToNativeVec3(JsValueRef jsVec3);
@@ -32,6 +42,14 @@ namespace EJSFunction {
 	UIElement* JSToNativeUI(JsValueRef jsUI);
 	RayCastHit* JsToNativeRaycast(JsValueRef jsRaycast);
 	Camera* JSToNativeCamera(JsValueRef jsCamera);
+	ECollisionEvent* JSToNativeCollisionEvent(JsValueRef jsCollisionEvent);
+	string JSToNativeString(JsValueRef jsString);
+	int JSToNativeLayer(JsValueRef jsLayer);
+	ETriggerVolume* JSToNativeTriggerVolume(JsValueRef jsTrigger);
+
+	// Finalizers
+	void CALLBACK JSFinalizeCollisionEvent(void *data);
+	void CALLBACK JSFinalizePhysicsSnapshot(void *data);
 
 	// Constructors
 	JsValueRef CALLBACK JSConstructorVec3(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
@@ -42,6 +60,11 @@ namespace EJSFunction {
 	JsValueRef CALLBACK JSConstructorUI(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
 	JsValueRef CALLBACK JSConstructorRaycastResult(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
 	JsValueRef CALLBACK JSConstructorCamera(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSConstructorCollisionEvent(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSConstructorTriggerVolume(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSConstructorPhysicsSnapshot(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSConstructorSoftBody(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSConstructorLamp(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
 
 // member functions
 
@@ -122,6 +145,44 @@ namespace EJSFunction {
 	JsValueRef CALLBACK JSAssetGetColliderOffsetPos(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
 	JsValueRef CALLBACK JSAssetGetColliderOffsetSize(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
 	JsValueRef CALLBACK JSAssetEqual(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSAssetSetCollisionEvents(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSAssetSetCollisionLayer(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSAssetGetCollisionLayer(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSAssetSetCcd(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSAssetSetCcdEnabled(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+
+	// CollisionEvent
+	JsValueRef CALLBACK JSCollisionEventGetType(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSCollisionEventGetAssetA(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSCollisionEventGetAssetB(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSCollisionEventGetPoint(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSCollisionEventGetNormal(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSCollisionEventGetImpulse(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+
+	// TriggerVolume
+	JsValueRef CALLBACK JSTriggerVolumeGetPosition(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSTriggerVolumeSetPosition(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSTriggerVolumeGetOverlapping(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSTriggerVolumeDelete(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSTriggerVolumeEqual(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+
+	// PhysicsSnapshot
+	JsValueRef CALLBACK JSPhysicsSnapshotRestore(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+
+	// SoftBody
+	JsValueRef CALLBACK JSSoftBodyPin(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSSoftBodyAnchor(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSSoftBodyAddForce(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSSoftBodyDelete(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+
+	// Lamp
+	JsValueRef CALLBACK JSLampSetType(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSLampGetType(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSLampSetSpotAngle(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSLampGetSpotAngle(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSLampSetRadius(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSLampGetRadius(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
+	JsValueRef CALLBACK JSLampSetDirection(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
 
 	// Camera 
 	JsValueRef CALLBACK JSCameraGetPosition(JsValueRef callee, bool isConstructCall, JsValueRef *arguments, unsigned short argumentCount, void *callbackState);
@@ -135,6 +196,18 @@ namespace EJSFunction {
 	JsValueRef CALLBACK JSKeyDown(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
 	JsValueRef CALLBACK JSRaycast(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
 	JsValueRef CALLBACK JSGetActiveCam(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSGetLayerMask(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSSetLayersCollide(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSOverlapSphere(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSOverlapBox(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSOverlapSpheres(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSSweepSphere(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSSweepBox(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSCapturePhysics(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSSetFixedTimestep(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSVerifyPhysicsReplay(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSSetCcdSpeedThreshold(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
+	JsValueRef CALLBACK JSBakePhysics(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
 
 	// RaycastResult
 	JsValueRef CALLBACK JSRaycastGetHitPos(JsValueRef callee, bool isConstructCall, JsValueRef * arguments, unsigned short argumentCount, void * callbackState);
@@ -0,0 +1,121 @@
+#include "EJobSystem.h"
+#include <algorithm>
+
+vector<thread> EJobSystem::workers;
+deque<function<void()>> EJobSystem::jobs;
+mutex EJobSystem::jobsMutex;
+condition_variable EJobSystem::jobsAvailable;
+bool EJobSystem::stopping = false;
+
+void EJobSystem::Start(unsigned int workerCount)
+{
+	if (!workers.empty())
+		return;
+	if (workerCount == 0) {
+		unsigned int hardware = thread::hardware_concurrency();
+		workerCount = hardware > 1 ? hardware - 1 : 1;
+	}
+	stopping = false;
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		workers.push_back(thread(WorkerLoop));
+	}
+}
+
+void EJobSystem::Stop()
+{
+	{
+		lock_guard<mutex> lock(jobsMutex);
+		stopping = true;
+	}
+	jobsAvailable.notify_all();
+	for (unsigned int i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+	workers.clear();
+}
+
+unsigned int EJobSystem::WorkerCount()
+{
+	return (unsigned int)workers.size();
+}
+
+void EJobSystem::WorkerLoop()
+{
+	while (true)
+	{
+		function<void()> job;
+		{
+			unique_lock<mutex> lock(jobsMutex);
+			jobsAvailable.wait(lock, [] { return stopping || !jobs.empty(); });
+			if (jobs.empty())
+				return;
+			job = move(jobs.front());
+			jobs.pop_front();
+		}
+		job();
+	}
+}
+
+bool EJobSystem::RunOne()
+{
+	function<void()> job;
+	{
+		lock_guard<mutex> lock(jobsMutex);
+		if (jobs.empty())
+			return false;
+		job = move(jobs.front());
+		jobs.pop_front();
+	}
+	job();
+	return true;
+}
+
+void EJobSystem::ParallelFor(unsigned int count, const function<void(unsigned int)>& job, unsigned int batchSize)
+{
+	if (batchSize == 0)
+		batchSize = 1;
+	unsigned int batches = (count + batchSize - 1) / batchSize;
+	if (workers.empty() || batches <= 1) {
+		for (unsigned int i = 0; i < count; i++)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	// every runner pulls batches until none are left, so uneven jobs balance themselves
+	atomic<unsigned int> next(0);
+	unsigned int runners = min(batches, (unsigned int)workers.size() + 1);
+	atomic<unsigned int> running(runners);
+	auto runner = [&]() {
+		unsigned int begin;
+		while ((begin = next.fetch_add(batchSize)) < count)
+		{
+			unsigned int end = min(begin + batchSize, count);
+			for (unsigned int i = begin; i < end; i++)
+			{
+				job(i);
+			}
+		}
+		running--;
+	};
+
+	{
+		lock_guard<mutex> lock(jobsMutex);
+		for (unsigned int i = 1; i < runners; i++)
+		{
+			jobs.push_back(runner);
+		}
+	}
+	jobsAvailable.notify_all();
+	runner();
+
+	// help with other queued jobs instead of idling, this also keeps nested calls from deadlocking
+	while (running > 0)
+	{
+		if (!RunOne())
+			this_thread::yield();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <EEngine.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <deque>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+///<summary>
+///pool of worker threads for splitting per frame work (queries, culling, solvers) across the cores
+///</summary>
+class DllExport EJobSystem
+{
+public:
+	///<summary>
+	///starts the workers, 0 uses one worker less than there are hardware threads since the caller helps out
+	///</summary>
+	static void Start(unsigned int workerCount = 0);
+
+	///<summary>
+	///finishes the queued jobs and joins the workers
+	///</summary>
+	static void Stop();
+
+	///<summary>
+	///calls job(i) for every i in [0, count) spread over the workers and the calling thread, returns once all calls are done.
+	///Runs inline if the system is not started or the work is smaller than one batch
+	///</summary>
+	///<param name="batchSize">
+	///number of consecutive indices a thread takes at once, raise it for very cheap jobs
+	///</param>
+	static void ParallelFor(unsigned int count, const function<void(unsigned int)>& job, unsigned int batchSize = 1);
+
+	static unsigned int WorkerCount();
+
+private:
+	static void WorkerLoop();
+	static bool RunOne();
+
+	static vector<thread> workers;
+	static deque<function<void()>> jobs;
+	static mutex jobsMutex;
+	static condition_variable jobsAvailable;
+	static bool stopping;
+};
@@ -0,0 +1,43 @@
+#include "ELightClusters.h"
+#include <Game.h>
+
+void ELightClusters::Initialize()
+{
+	cullShader = new Shader("..\\shaders\\LightCull.comp");
+	uniformView = EOGLUniform<mat4>(cullShader, "view", mat4(1));
+	uniformInvProj = EOGLUniform<mat4>(cullShader, "invProj", mat4(1));
+	uniformLightCount = EOGLUniform<int>(cullShader, "lightCount", 0);
+
+	// the buffers are only written and read on the GPU
+	glGenBuffers(1, &clusterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, clusterCount * 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+	glGenBuffers(1, &indexBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, indexBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, clusterCount * averageLightsPerCluster * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+	glGenBuffers(1, &counterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void ELightClusters::Build(int lightCount)
+{
+	// the clusters allocate their ranges of the index list with an atomic counter
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffer);
+	glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	cullShader->use();
+	uniformView.Update(Game::View);
+	uniformInvProj.Update(inverse(Game::Projection));
+	uniformLightCount.Update(lightCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, clusterBinding, clusterBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, indexBinding, indexBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, counterBinding, counterBuffer);
+	glDispatchCompute((clusterCount + 63) / 64, 1, 1);
+
+	// the illumination pass reads the lists in its fragment shader
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <EEngine.h>
+#include <Shader.h>
+#include <EOGLUniform.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace glm;
+
+///<summary>
+///splits the view frustum into a grid of clusters, sizeX x sizeY tiles on screen and sizeZ slices that grow exponentially from the near to the far plane,
+///and builds the list of lamps whose range touches each cluster in a compute shader. The illumination pass only shades the lamps in the list of the cluster of a pixel
+///</summary>
+class DllExport ELightClusters
+{
+public:
+	///<summary>
+	///creates the buffers and loads the compute shader, the shader defines have to be set before
+	///</summary>
+	void Initialize();
+
+	///<summary>
+	///builds the light lists from the lamp positions and ranges in binding 4, call after they were written for this frame
+	///</summary>
+	void Build(int lightCount);
+
+	static const int sizeX = 16;
+	static const int sizeY = 9;
+	static const int sizeZ = 24;
+	static const int clusterCount = sizeX * sizeY * sizeZ;
+	// space for the light indices of all clusters, lamps beyond it are dropped from the last clusters that are built
+	static const int averageLightsPerCluster = 64;
+
+	// offset and count of every cluster in the index list, the lamp indices and the number of indices written
+	static const int clusterBinding = 21;
+	static const int indexBinding = 22;
+	static const int counterBinding = 23;
+
+private:
+	Shader* cullShader = nullptr;
+	EOGLUniform<mat4> uniformView;
+	EOGLUniform<mat4> uniformInvProj;
+	EOGLUniform<int> uniformLightCount;
+	GLuint clusterBuffer = 0;
+	GLuint indexBuffer = 0;
+	GLuint counterBuffer = 0;
+};
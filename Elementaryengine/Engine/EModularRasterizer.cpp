@@ -48,7 +48,12 @@ void EModularRasterizer::Setup(EOpenGl * eOpenGl, EDisplaySettings * displaySett
 	glGenVertexArrays(1, &eOpenGl->vao);
 	glGenBuffers(1, &eOpenGl->gElementBuffer);
 	glGenBuffers(1, &eOpenGl->gIndirectBuffer);
+	glGenBuffers(1, &eOpenGl->gCulledIndirectBuffer);
+	glGenBuffers(1, &eOpenGl->gVisibleInstanceBuffer);
+	glGenBuffers(1, &eOpenGl->gLateIndirectBuffer);
+	glGenBuffers(1, &eOpenGl->gOccludedInstanceBuffer);
 	glGenBuffers(1, &eOpenGl->gVertexBuffer);
+	eOpenGl->geometryPool.Setup(eOpenGl->gVertexBuffer, eOpenGl->gElementBuffer);
 
 	Asset::rendererAssetCreatedCallback = &AssetCreatedCallback;
 	Asset::rendererAssetChangedCallback = &AssetChangedCallback;
@@ -63,14 +68,60 @@ void EModularRasterizer::Setup(EOpenGl * eOpenGl, EDisplaySettings * displaySett
 	//postPass = new EPostPass(eOpenGL->gPosition, eOpenGL->gNormal, eOpenGL->gAlbedoSpec, eOpenGL->gMaterial, illuminationPass->frameOut, eOpenGL->gDepth);
 
 	shadowPass = new EShadowPass(eOpenGL->vao, eOpenGL->gElementBuffer, eOpenGL->gIndirectBuffer, eOpenGL->instance, &shadowMaps);
+	shadowPass->AtlasSize = renderSettings.shadowAtlasSize;
+	shadowPass->SunCascades = renderSettings.sunCascadeCount;
+	shadowPass->SunShadowDistance = renderSettings.sunShadowDistance;
 	geometryPass = new EGeometryPass(&eOpenGL->gPosition, &eOpenGL->gNormal, &eOpenGL->gAlbedoSpec, &eOpenGL->gMaterial, &eOpenGL->gDepth);
+	if (renderSettings.useGpuCulling) {
+		shadowPass->CullCasters = true;
+		// occlusion culling tests against the depth of the early draws, what turns out visible is drawn by the late geometry pass
+		if (renderSettings.useOcclusionCulling) {
+			hiZPass = new EHiZPass(eOpenGL->gDepth);
+			lateCullingPass = new ECullingPass(hiZPass, true);
+			lateGeometryPass = new EGeometryPass(geometryPass);
+			lateGeometryPass->IndirectBuffer = eOpenGL->gLateIndirectBuffer;
+		}
+		cullingPass = new ECullingPass(hiZPass);
+		geometryPass->IndirectBuffer = eOpenGL->gCulledIndirectBuffer;
+	}
 	illuminationPass = new EIlluminationPass(eOpenGL->gPosition, eOpenGL->gNormal, eOpenGL->gAlbedoSpec, eOpenGL->gMaterial, eOpenGL->gDepth);
+	illuminationPass->ClusteredLighting = renderSettings.useClusteredLighting;
+	if (renderSettings.useBasicVolumetricLighting) {
+		volumetricPass = new EVolumetricPass(eOpenGL->gDepth, illuminationPass->frameOut);
+		volumetricPass->ResolutionScale = renderSettings.basicVolumetricLightingResolutionMultiplyer;
+		volumetricPass->HistoryBlend = renderSettings.basicVolumetricLightingHistoryBlend;
+	}
+	if (renderSettings.useSSR) {
+		// the reflections trace against the closest depth of the finished geometry
+		closestHiZPass = new EHiZPass(eOpenGL->gDepth, true);
+		reflectionPass = new EReflectionPass(closestHiZPass, eOpenGL->gPosition, eOpenGL->gNormal, eOpenGL->gAlbedoSpec, eOpenGL->gMaterial, illuminationPass->frameOut);
+		reflectionPass->ResolutionScale = renderSettings.ssrResolutionMultiplyer;
+		reflectionPass->MaxRoughness = renderSettings.ssrMaxRoughness;
+		reflectionPass->MaxSteps = renderSettings.ssrMaxSteps;
+	}
 	postPass = new EPostPass(eOpenGL->gPosition, eOpenGL->gNormal, eOpenGL->gAlbedoSpec, eOpenGL->gMaterial, illuminationPass->frameOut, eOpenGL->gDepth);
 	textPass = new ETextPass();
 
 	renderPasses.push_back(shadowPass);
+	if (renderSettings.useGpuCulling) {
+		renderPasses.push_back(cullingPass);
+	}
 	renderPasses.push_back(geometryPass);
+	if (hiZPass != nullptr) {
+		renderPasses.push_back(hiZPass);
+		renderPasses.push_back(lateCullingPass);
+		renderPasses.push_back(lateGeometryPass);
+	}
+	if (closestHiZPass != nullptr) {
+		renderPasses.push_back(closestHiZPass);
+	}
 	renderPasses.push_back(illuminationPass);
+	if (volumetricPass != nullptr) {
+		renderPasses.push_back(volumetricPass);
+	}
+	if (reflectionPass != nullptr) {
+		renderPasses.push_back(reflectionPass);
+	}
 	renderPasses.push_back(postPass);
 	renderPasses.push_back(textPass);
 
@@ -97,6 +148,33 @@ string EModularRasterizer::getShaderDefines()
 		out += "false \n";
 	}
 
+	if (renderSettings.useGpuCulling) {
+		out += "#define gpuCulling \n";
+	}
+
+	// the shadow pass renders into the atlas
+	out += "#define shadowAtlas \n";
+
+	// the volumetric light has its own pass instead of being marched by the illumination
+	if (renderSettings.useBasicVolumetricLighting) {
+		out += "#define volumetricPass \n";
+		out += "#define vlDensity " + std::to_string(renderSettings.basicVolumetricLightingDensity) + " \n";
+	}
+
+	if (renderSettings.useClusteredLighting) {
+		out += "#define clusteredLighting \n";
+		out += "#define clusterX " + std::to_string(ELightClusters::sizeX) + " \n";
+		out += "#define clusterY " + std::to_string(ELightClusters::sizeY) + " \n";
+		out += "#define clusterZ " + std::to_string(ELightClusters::sizeZ) + " \n";
+	}
+
+	// the post pass only tests the ui elements sorted into the tile of a pixel
+	out += "#define uiTiles \n";
+	out += "#define uiTileSize " + std::to_string(EPostPass::uiTileSize) + " \n";
+	out += "#define uiTileElements " + std::to_string(EPostPass::uiTileElements) + " \n";
+	// the ui background blur samples the blur pyramid of the post pass
+	out += "#define blurPyramid \n";
+
 	out += "#define useSSR ";
 	if (renderSettings.useSSR) {
 		out += "true \n";
@@ -144,6 +222,7 @@ Texture* EModularRasterizer::loadTexture(const char * path)
 void EModularRasterizer::AssetCreatedCallback(Asset * asset)
 {
 	assetCreated = true;
+	EShadowCache::InvalidateAll();
 }
 
 void EModularRasterizer::AssetChangedCallback(Asset * asset)
@@ -156,11 +235,13 @@ void EModularRasterizer::AssetChangedCallback(Asset * asset)
 		}
 	}
 	if (c)assetChanged = true;
+	EShadowCache::AssetChanged(asset);
 }
 
 void EModularRasterizer::AssetDestroyedCallback(Asset * asset)
 {
 	assetCreated = true;
+	EShadowCache::InvalidateAll();
 }
 
 
@@ -168,33 +249,23 @@ void EModularRasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpen
 {
 	// see if new mesh is loaded or new asset is created
 	if (meshChanged || assetsChanged) {
-		// clear the composed Mesh if needed
-		if (meshChanged) {
-			eOpenGl->vVertex.clear();
-			eOpenGl->vVertex.resize(0);
-			eOpenGl->gIndex.clear();
-			eOpenGl->gIndex.resize(0);
-		}
 		// clear the draw command buffer if needed
 		if (assetsChanged || meshChanged) {
 			eOpenGl->dICommands.clear();
 			eOpenGl->dICommands.resize(0);
 			eOpenGl->drawInstanceOffset.clear();
 			eOpenGl->drawInstanceOffset.push_back(0);
-			eOpenGl->currentIndexOffset = 0;
+			eOpenGl->drawBounds.clear();
+			eOpenGl->instanceDraw.clear();
 			eOpenGl->currentVertexOffset = 0;
 			eOpenGl->instance = 0;
 		}
 		// redo mesh array
 		for each (Mesh* m in Game::meshs) {
 
-			// only need to add the mesh to the composed mesh if the composed mesh needs rebuilding
+			// new meshes get their ranges in the geometry pool, only they are uploaded
 			if (meshChanged) {
-				// Append indices
-				eOpenGl->gIndex.insert(eOpenGl->gIndex.end(), m->indices.begin(), m->indices.end());
-
-				// Append vertices
-				eOpenGl->vVertex.insert(eOpenGl->vVertex.end(), m->vertices.begin(), m->vertices.end());
+				eOpenGl->geometryPool.Add(m);
 			}
 			// create a new draw command
 			DrawElementsIndirectCommand c = DrawElementsIndirectCommand();
@@ -211,19 +282,24 @@ void EModularRasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpen
 			parentcount = (parentcount > 0) ? parentcount - 1 : -1;
 			eOpenGl->drawInstanceOffset.push_back(lastoffset + parentcount);
 
-			// first index of the composed mesh that belongs to the current mesh
-			c.firstIndex = eOpenGl->currentIndexOffset;
+			// first index of the geometry pool that belongs to the current mesh
+			c.firstIndex = m->indexOffset;
+
+			// first vertex of the geometry pool that belongs to the current mesh
+			c.baseVertex = m->vertexOffset;
 
-			// first vertex of the composed mesh that belongs to the current mesh
-			c.baseVertex = eOpenGl->currentVertexOffset;
+			// first instance of the draw, the culled draw finds its visible instances from there
+			c.baseInstance = eOpenGl->instanceDraw.size();
 
-			// index of the mesh in the composed mesh
-			c.baseInstance = eOpenGl->instance;
+			// culling input, the vertices of dynamic meshes move away from their bounds
+			eOpenGl->drawBounds.push_back(m->dynamicVertices ? vec4(0, 0, 0, -1) : m->bounds);
+			for (int i = 0; i < m->parents.size(); i++)
+			{
+				eOpenGl->instanceDraw.push_back(eOpenGl->instance);
+			}
 
 			// increase counters
 			eOpenGl->instance++;
-			eOpenGl->currentIndexOffset += m->indices.size();
-			eOpenGl->currentVertexOffset += m->vertices.size();
 
 			// add draw command to the list
 			eOpenGl->dICommands.push_back(c);
@@ -234,9 +310,8 @@ void EModularRasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpen
 		// bind main vertex array object (prior vao should be from the PostFx stage);
 		glBindVertexArray(eOpenGl->vao);
 
-		// resize vertex array object
+		// the geometry pool keeps its buffers, they only need to be bound
 		glBindBuffer(GL_ARRAY_BUFFER, eOpenGl->gVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, eOpenGl->vVertex.size() * sizeof(Vertex), &eOpenGl->vVertex[0], GL_STATIC_DRAW);
 
 
 		// copy vertex positions
@@ -250,18 +325,27 @@ void EModularRasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpen
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
 
 
-		// resize and copy element buffer
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eOpenGl->gElementBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, eOpenGl->gIndex.size() * sizeof(unsigned int), &eOpenGl->gIndex[0], GL_STATIC_DRAW);
 
 		// resize and copy draw command buffer
 		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, eOpenGl->gIndirectBuffer);
 		glBufferData(GL_DRAW_INDIRECT_BUFFER, eOpenGl->dICommands.size() * sizeof(DrawElementsIndirectCommand), &eOpenGl->dICommands[0], GL_STATIC_DRAW);
 
-		// resize and copy offset buffer
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->drawIdOffsetBuffer);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * eOpenGl->drawInstanceOffset.size(), eOpenGl->drawInstanceOffset.data(), GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, eOpenGl->drawIdOffsetBuffer);
+		// the culling pass overwrites the instance counts of this copy every frame
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, eOpenGl->gCulledIndirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, eOpenGl->dICommands.size() * sizeof(DrawElementsIndirectCommand), &eOpenGl->dICommands[0], GL_DYNAMIC_COPY);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, eOpenGl->gLateIndirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, eOpenGl->dICommands.size() * sizeof(DrawElementsIndirectCommand), &eOpenGl->dICommands[0], GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->gVisibleInstanceBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (std::max)((size_t)1, eOpenGl->instanceDraw.size()) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->gOccludedInstanceBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (std::max)((size_t)1, eOpenGl->instanceDraw.size()) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		eOpenGl->meshBoundsSSBO.Write(eOpenGl->drawBounds.data(), sizeof(vec4) * eOpenGl->drawBounds.size(), 8);
+		eOpenGl->instanceDrawSSBO.Write(eOpenGl->instanceDraw.data(), sizeof(GLuint) * eOpenGl->instanceDraw.size(), 9);
+
+		// copy offset buffer
+		eOpenGl->drawIdOffsetBuffer.Write(eOpenGl->drawInstanceOffset.data(), sizeof(int) * eOpenGl->drawInstanceOffset.size(), 6);
 
 	}
 }
@@ -288,9 +372,7 @@ void EModularRasterizer::BuildUI(EOpenGl * eOpenGl)
 		eOpenGl->ERUIElements.push_back(u);
 	}
 	// copy the atribute vector to the GPU
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, eOpenGl->uiElementsSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ERendererUIElement) * eOpenGl->ERUIElements.size(), eOpenGl->ERUIElements.data(), GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	eOpenGl->uiElementsSSBO.Write(eOpenGl->ERUIElements.data(), sizeof(ERendererUIElement) * eOpenGl->ERUIElements.size(), 7);
 
 }
 
@@ -334,15 +416,15 @@ void EModularRasterizer::BuildDrawAtrib(EOpenGl * eOpenGl)
 		}
 
 		// copy the atribute vector to the GPU
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, eOpenGl->meshDataSSBO);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawMeshAtributes) * drawAtrib.size(), drawAtrib.data(), GL_DYNAMIC_DRAW);
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		eOpenGl->meshDataSSBO.Write(drawAtrib.data(), sizeof(DrawMeshAtributes) * drawAtrib.size(), 5);
 	}
 }
 
 void EModularRasterizer::SetupFrame(bool meshChanged, EOpenGl * eOpenGl)
 {
 	BuildMeshes(assetChanged || assetCreated, meshChanged, eOpenGl);
+	// changed vertices (soft bodies) are uploaded into their own ranges
+	eOpenGl->UpdateVertices(Game::meshs);
 	BuildDrawAtrib(eOpenGl);
 }
 
@@ -375,20 +457,22 @@ void EModularRasterizer::SetupLamps(EOpenGl * eOpenGl, Shader * shader)
 	// create vectors for light colors and positions
 	vector<vec4> lightColors;
 	vector<vec4> lightPositions;
+	vector<vec4> lightDirections;
 
-	// add color and position for each light to vectors
+	// add color, position and cone for each light to vectors
 	for each (Lamp* l in Game::lamps) {
 		vec3 outcol = l->color;
 		vec3 outpos = l->parents[0]->position;
 		lightColors.push_back(vec4(outcol, 0));
-		lightPositions.push_back(vec4(outpos, 0));
+		lightPositions.push_back(vec4(outpos, l->radius));
+		lightDirections.push_back(l->getCone());
 	}
 
 	// dont do this for the ssr shader
 	if (shader != Mesh::ssrShader) {
-		// bind Shadowmap texture array and set its uniform
+		// bind the shadow atlas and set its uniform
 		glActiveTexture(GL_TEXTURE8);
-		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, Game::eOpenGl->shadowMaps);
+		glBindTexture(GL_TEXTURE_2D, Game::eOpenGl->shadowMaps);
 		if (eOpenGl->lightingUniformShadowMaps < 0) {
 			eOpenGl->lightingUniformShadowMaps = glGetUniformLocation(shader->ID, "shadowMaps");
 		}
@@ -397,16 +481,13 @@ void EModularRasterizer::SetupLamps(EOpenGl * eOpenGl, Shader * shader)
 
 
 	// copy color SSBO
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->lightColorSSBO);
-	GLsizeiptr lcs = sizeof(glm::vec4) * (lightColors.size());
-	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, eOpenGl->lightColorSSBO, 0, lcs);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, lcs, lightColors.data(), GL_DYNAMIC_DRAW);
+	eOpenGl->lightColorSSBO.Write(lightColors.data(), sizeof(glm::vec4) * lightColors.size(), 3);
 
 	// copy position SSBO
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->lightPositionSSBO);
-	GLsizeiptr lps = sizeof(glm::vec4) * lightPositions.size();
-	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, eOpenGl->lightPositionSSBO, 0, lps);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, lps, lightPositions.data(), GL_DYNAMIC_DRAW);
+	eOpenGl->lightPositionSSBO.Write(lightPositions.data(), sizeof(glm::vec4) * lightPositions.size(), 4);
+
+	// copy cone SSBO
+	eOpenGl->lightDirectionSSBO.Write(lightDirections.data(), sizeof(glm::vec4) * lightDirections.size(), 19);
 }
 
 void EModularRasterizer::RenderUI(EOpenGl * eOpenGl, EDisplaySettings * displaySettings)
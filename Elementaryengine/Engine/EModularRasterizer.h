@@ -5,9 +5,12 @@
 #include <ERenderPass.h>
 #include "EIlluminationPass.h"
 #include <EGeometryPass.h>
+#include <ECullingPass.h>
 #include "EPostPass.h"
 #include <EShadowPass.h>
 #include <ETextPass.h>
+#include <EVolumetricPass.h>
+#include <EReflectionPass.h>
 #include <EModularRenderSettings.h>
 
 class EModularRasterizer : public ERenderer
@@ -42,11 +45,18 @@ private:
 
 	EIlluminationPass * illuminationPass;
 	EGeometryPass * geometryPass;
+	ECullingPass * cullingPass = nullptr;
+	EHiZPass * hiZPass = nullptr;
+	ECullingPass * lateCullingPass = nullptr;
+	EGeometryPass * lateGeometryPass = nullptr;
+	EVolumetricPass * volumetricPass = nullptr;
+	EHiZPass * closestHiZPass = nullptr;
+	EReflectionPass * reflectionPass = nullptr;
 	EPostPass * postPass;
 	EShadowPass * shadowPass;
 	ETextPass * textPass;
 	///<summary>
-	///builds the composed mesh needed for multiDrawIndirect and copies it to the GPU buffers
+	///adds new meshes to the geometry pool and builds the draw commands needed for multiDrawIndirect
 	///</summary> 
 	///<param name="assetsChanged">
 	///indicates if the assets changed last frame (NOT their atributes)
@@ -5,11 +5,35 @@ public:
 	EModularRenderSettings();
 	~EModularRenderSettings();
 	
+	// the volumetric light is marched in its own pass at a part of the window resolution and accumulated over the frames,
+	// so every pixel needs only a few steps per frame
 	bool useBasicVolumetricLighting = true;
 	float basicVolumetricLightingResolutionMultiplyer = 0.5f;
 	float basicVolumetricLightingMaxBrightness = 0.7f;
-	int basicVolumetricLightingSteps = 240;
+	int basicVolumetricLightingSteps = 24;
+	// how much light the air scatters per unit of distance
+	float basicVolumetricLightingDensity = 0.02f;
+	// the part of a new frame in the accumulated light, lower is smoother but reacts slower to moving lamps
+	float basicVolumetricLightingHistoryBlend = 0.1f;
 
+	// screen space reflections, traced at a part of the window resolution for the surfaces smoother than ssrMaxRoughness
 	bool useSSR = true;
+	float ssrResolutionMultiplyer = 0.5f;
+	float ssrMaxRoughness = 0.6f;
+	int ssrMaxSteps = 48;
+
+	// builds a list of the lamps that reach every cluster of the view, so the illumination pass only shades the lamps near a pixel
+	bool useClusteredLighting = true;
+
+	// frustum culling of the instances on the GPU before the geometry pass
+	bool useGpuCulling = true;
+	// culls the instances hidden behind the depth of the last frame, needs useGpuCulling
+	bool useOcclusionCulling = true;
+
+	// size of the shadow atlas the lamps get their shadow tiles from
+	unsigned int shadowAtlasSize = 4096;
+	// cascades of the sun shadows (up to 6, 0 turns them off) and how far from the camera they reach
+	int sunCascadeCount = 4;
+	float sunShadowDistance = 100.0f;
 };
 
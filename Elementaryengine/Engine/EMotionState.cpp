@@ -0,0 +1,81 @@
+#include "EMotionState.h"
+#include <Asset.h>
+#include <algorithm>
+
+vector<EMotionState*> EMotionState::changed;
+mutex EMotionState::changedMutex;
+
+EMotionState::EMotionState(Asset * asset, const btTransform & startTransform)
+{
+	this->asset = asset;
+	transform = startTransform;
+}
+
+EMotionState::~EMotionState()
+{
+	Detach();
+}
+
+void EMotionState::getWorldTransform(btTransform & worldTransform) const
+{
+	worldTransform = transform;
+}
+
+void EMotionState::setWorldTransform(const btTransform & worldTransform)
+{
+	lock_guard<mutex> lock(changedMutex);
+	// active bodies get synced every step, only queue the ones that actually moved
+	if (asset == nullptr || transform == worldTransform)
+		return;
+	transform = worldTransform;
+	if (!queued) {
+		queued = true;
+		changed.push_back(this);
+	}
+}
+
+void EMotionState::Detach()
+{
+	lock_guard<mutex> lock(changedMutex);
+	if (queued) {
+		changed.erase(std::remove(changed.begin(), changed.end(), this), changed.end());
+		queued = false;
+	}
+	asset = nullptr;
+}
+
+void EMotionState::SyncChangedAssets()
+{
+	struct ChangedTransform
+	{
+		Asset* asset;
+		btTransform transform;
+	};
+	vector<ChangedTransform> moved;
+	{
+		lock_guard<mutex> lock(changedMutex);
+		moved.reserve(changed.size());
+		for each (EMotionState* state in changed)
+		{
+			moved.push_back({ state->asset, state->transform });
+			state->queued = false;
+		}
+		changed.clear();
+	}
+
+	for each (ChangedTransform c in moved)
+	{
+		btVector3 origin = c.transform.getOrigin();
+		btQuaternion rotation = c.transform.getRotation();
+		c.asset->position.x = origin.getX() - c.asset->collisionPosOffset.x;
+		c.asset->position.y = origin.getY() - c.asset->collisionPosOffset.y;
+		c.asset->position.z = origin.getZ() - c.asset->collisionPosOffset.z;
+
+		c.asset->q.w = rotation.getW();
+		c.asset->q.x = rotation.getX();
+		c.asset->q.y = rotation.getY();
+		c.asset->q.z = rotation.getZ();
+
+		Asset::rendererAssetChangedCallback(c.asset);
+	}
+}
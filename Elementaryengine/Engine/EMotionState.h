@@ -0,0 +1,46 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+#include <mutex>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+///<summary>
+///motion state of an asset's rigid body. Bullet only writes to it for active bodies, moved bodies get queued for the render sync instead of every asset being polled each frame
+///</summary>
+class DllExport EMotionState :
+	public btMotionState
+{
+public:
+	EMotionState(Asset* asset, const btTransform& startTransform);
+	~EMotionState();
+
+	virtual void getWorldTransform(btTransform& worldTransform) const;
+
+	///<summary>
+	///called by Bullet on the physics thread for every active body after a step
+	///</summary>
+	virtual void setWorldTransform(const btTransform& worldTransform);
+
+	///<summary>
+	///stops syncing to the asset and drops a pending update, call before the asset is deleted
+	///</summary>
+	void Detach();
+
+	///<summary>
+	///writes the transforms of all bodies that moved since the last call to their assets and notifies the renderer. Call on the game thread
+	///</summary>
+	static void SyncChangedAssets();
+
+private:
+	Asset* asset;
+	btTransform transform;
+	bool queued = false;
+
+	// motion states that moved since the last sync, guarded by changedMutex
+	static vector<EMotionState*> changed;
+	static mutex changedMutex;
+};
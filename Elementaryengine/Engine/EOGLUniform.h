@@ -19,7 +19,7 @@ public:
 	T _value;
 	T* _valuePt;
 	string _name;
-	int locationCache;
+	int locationCache = -1;
 	typedef T(*ValueFn)();
 
 	//using _valueFunction = std::function<T()>;
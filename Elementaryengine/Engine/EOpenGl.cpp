@@ -134,11 +134,7 @@ void EOpenGl::Initialise(EDisplaySettings * settings)
 	//	std::cout << "Framebuffer not complete!" << std::endl;
 	//glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-	// light buffers
-	glGenBuffers(1, &lightColorSSBO);
-	glGenBuffers(1, &lightPositionSSBO);
-	glGenBuffers(1, &meshDataSSBO);
-	glGenBuffers(1, &drawIdOffsetBuffer);
+	// the light, mesh data and draw offset buffers create their storage when they are first written
 	//// VXAO
 	//glGenFramebuffers(1, &vBuffer);
 	//glBindFramebuffer(GL_FRAMEBUFFER, vBuffer);
@@ -197,4 +193,14 @@ void EOpenGl::CleanUp()
 	glfwTerminate();
 }
 
+void EOpenGl::UpdateVertices(const vector<Mesh*>& meshes)
+{
+	for each (Mesh* m in meshes)
+	{
+		if (m->verticesChanged) {
+			geometryPool.UpdateVertices(m);
+		}
+	}
+}
+
 
@@ -6,6 +6,8 @@
 #include <Material.h>
 #include <Shader.h>
 #include <Mesh.h>
+#include <EGeometryPool.h>
+#include <EStreamBuffer.h>
 
 
 struct EDisplaySettings
@@ -71,11 +73,16 @@ public:
 	// Gemetry Buffer 
 	unsigned int gBuffer;
 	unsigned int gPosition, gNormal, gColorSpec, gAlbedoSpec, gMaterial, gDepth;
-	GLuint lightColorSSBO = 0;
-	GLuint lightPositionSSBO = 0;
-	GLuint meshDataSSBO = 0;
-	GLuint uiElementsSSBO = 0;
-	GLuint drawIdOffsetBuffer = 0;
+	// rewritten between frames, so they stream through mapped memory
+	EStreamBuffer lightColorSSBO{ GL_SHADER_STORAGE_BUFFER };
+	EStreamBuffer lightPositionSSBO{ GL_SHADER_STORAGE_BUFFER };
+	EStreamBuffer lightDirectionSSBO{ GL_SHADER_STORAGE_BUFFER };
+	EStreamBuffer meshDataSSBO{ GL_SHADER_STORAGE_BUFFER };
+	EStreamBuffer uiElementsSSBO{ GL_SHADER_STORAGE_BUFFER };
+	EStreamBuffer drawIdOffsetBuffer{ GL_SHADER_STORAGE_BUFFER };
+	// culling input: bounding sphere per draw command and draw command per instance
+	EStreamBuffer meshBoundsSSBO{ GL_SHADER_STORAGE_BUFFER };
+	EStreamBuffer instanceDrawSSBO{ GL_SHADER_STORAGE_BUFFER };
 
 	unsigned int lBuffer, frameOut;
 	GLuint64 texAHandle;
@@ -84,17 +91,28 @@ public:
 	unsigned int gArrayTexutre;
 	unsigned int gElementBuffer;
 	unsigned int gIndirectBuffer;
+	// draw commands with only the visible instances and the ids of those instances, written by the culling pass
+	unsigned int gCulledIndirectBuffer;
+	unsigned int gVisibleInstanceBuffer;
+	// draw commands of the instances the occlusion test only found visible in the second try, and which instances to try again
+	unsigned int gLateIndirectBuffer;
+	unsigned int gOccludedInstanceBuffer;
 	GLuint vao;
-	//Render Buffers vertex and index Buffer
-	vector<Vertex> vVertex;
-	vector<unsigned int>gIndex;
+	//Render Buffers vertex and index Buffer, every mesh has its own range in them
+	EGeometryPool geometryPool;
 
 	// offset for Multidraw inderect instancing
 	vector<int> drawInstanceOffset;
-	int currentIndexOffset = 0;
 	int currentVertexOffset = 0;
 	int instance = 0;
 	vector<DrawElementsIndirectCommand> dICommands;
+	vector<vec4> drawBounds;
+	vector<GLuint> instanceDraw;
+
+	///<summary>
+	///uploads the meshes whose vertices changed into their ranges of the geometry pool
+	///</summary>
+	void UpdateVertices(const vector<Mesh*>& meshes);
 
 	vector<ERendererUIElement> ERUIElements;
 
@@ -157,6 +175,7 @@ public:
 
 	// shadowmaps
 	int shadowUniformLayer = -1;
+	int shadowUniformFaceCount = -1;
 	int shadowUniformShadowMatrices = -1;
 	int shadowUniformFar_plane = -1;
 	int shadoeUniformLightPos = -1;
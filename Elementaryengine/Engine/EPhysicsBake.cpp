@@ -0,0 +1,245 @@
+#include "EPhysicsBake.h"
+#include <Game.h>
+#include <BulletCollision\CollisionDispatch\btCollisionWorldImporter.h>
+#include <Bullet3Serialize\Bullet2FileLoader\b3BulletFile.h>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+
+bool EPhysicsBake::loaded = false;
+bool EPhysicsBake::matching = false;
+vector<EBakedBody> EPhysicsBake::bodies;
+size_t EPhysicsBake::nextBody = 0;
+map<Asset*, size_t> EPhysicsBake::assetBodies;
+
+// bParse reads against the dna of this bullet build instead of the older one it was shipped with, the structs then have the layout of btSerializer.h
+class EBakeFile : public bParse::b3BulletFile
+{
+public:
+	EBakeFile(char* buffer, int length) : b3BulletFile(buffer, length) {}
+
+	bool parseNative()
+	{
+		if (bParse::VOID_IS_8) {
+			parseInternal(0, sBulletDNAstr64, sBulletDNAlen64);
+		}
+		else {
+			parseInternal(0, sBulletDNAstr, sBulletDNAlen);
+		}
+		return ok();
+	}
+};
+
+// builds the shapes without a world, they are looked up by the shape data the bodies point to
+class EBakeImporter : public btCollisionWorldImporter
+{
+public:
+	EBakeImporter() : btCollisionWorldImporter(nullptr) {}
+
+	btCollisionShape* Shape(const void* shapeData)
+	{
+		btCollisionShape** shape = m_shapeMap.find(shapeData);
+		return shape != nullptr ? *shape : nullptr;
+	}
+};
+
+bool EPhysicsBake::Bake(string path)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	btSerializer* serializer = new btDefaultSerializer();
+	serializer->startSerialization();
+
+	// the serializer keeps the name pointers until it is finished
+	vector<string> names;
+	names.reserve(Game::nextAssets.size());
+	int count = 0;
+	for each (Asset* a in Game::nextAssets)
+	{
+		btRigidBody* body = a->getRigidBody();
+		if (body == nullptr)
+			continue;
+		// shared shapes (model compounds, their hulls) are written once
+		btCollisionShape* shape = body->getCollisionShape();
+		if (serializer->findPointer(shape) == nullptr) {
+			shape->serializeSingleShape(serializer);
+		}
+		// the name holds what the asset asked for, so Load can tell if the scene still matches
+		vec3 size = a->getScale() * a->collisionSizeOffset;
+		char name[96];
+		snprintf(name, sizeof(name), "%d %.9g %.9g %.9g", (int)a->assetShape, size.x, size.y, size.z);
+		names.push_back(name);
+		serializer->registerNameForPointer(body, names.back().c_str());
+		body->serializeSingleObject(serializer);
+		count++;
+	}
+	serializer->finishSerialization();
+
+	ofstream out(path, ios::binary | ios::trunc);
+	bool written = out && out.write((const char*)serializer->getBufferPointer(), serializer->getCurrentBufferSize());
+	delete serializer;
+	if (!written) {
+		Game::console.Print("could not write the physics bake %s", path.c_str());
+		return false;
+	}
+	Game::console.Print("baked %d bodies to %s", count, path.c_str());
+	return true;
+}
+
+bool EPhysicsBake::Load(string path)
+{
+	Finish();
+
+	ifstream in(path, ios::binary | ios::ate);
+	if (!in)
+		return false;
+	vector<char> file((size_t)in.tellg());
+	in.seekg(0);
+	if (file.size() < BT_HEADER_LENGTH || !in.read(file.data(), file.size()))
+		return false;
+
+	// only files of this build, so the structs come out exactly as btSerializer.h declares them
+	btDefaultSerializer serializer;
+	unsigned char header[BT_HEADER_LENGTH];
+	serializer.writeHeader(header);
+	if (memcmp(header, file.data(), BT_HEADER_LENGTH) != 0) {
+		Game::console.Print("the physics bake %s was written by another build, it gets baked again", path.c_str());
+		return false;
+	}
+
+	EBakeFile bakeFile(file.data(), (int)file.size());
+	if (!bakeFile.ok() || !bakeFile.parseNative()) {
+		Game::console.Print("the physics bake %s is damaged", path.c_str());
+		return false;
+	}
+
+	btBulletSerializedArrays arrays;
+	for (int i = 0; i < bakeFile.m_collisionShapes.size(); i++)
+	{
+		arrays.m_colShapeData.push_back((btCollisionShapeData*)bakeFile.m_collisionShapes[i]);
+	}
+	EBakeImporter importer;
+	importer.convertAllObjects(&arrays);
+
+	for (int i = 0; i < bakeFile.m_rigidBodies.size(); i++)
+	{
+		const btRigidBodyFloatData* bodyData = (const btRigidBodyFloatData*)bakeFile.m_rigidBodies[i];
+		const btCollisionObjectFloatData& objectData = bodyData->m_collisionObjectData;
+		EBakedBody baked;
+		if (objectData.m_name == nullptr || sscanf(objectData.m_name, "%d %f %f %f", &baked.assetShape, &baked.size.x, &baked.size.y, &baked.size.z) != 4) {
+			baked.assetShape = -1;
+		}
+		baked.shape = importer.Shape(objectData.m_collisionShape);
+		baked.transform.deSerializeFloat(objectData.m_worldTransform);
+		baked.mass = bodyData->m_inverseMass > 0 ? 1 / bodyData->m_inverseMass : 0;
+		baked.collisionFlags = objectData.m_collisionFlags;
+		baked.friction = objectData.m_friction;
+		baked.restitution = objectData.m_restitution;
+		bodies.push_back(baked);
+	}
+
+	loaded = true;
+	matching = true;
+	return true;
+}
+
+bool EPhysicsBake::Loaded()
+{
+	return loaded;
+}
+
+void EPhysicsBake::Next(Asset * asset)
+{
+	if (!matching)
+		return;
+	if (nextBody >= bodies.size()) {
+		Game::console.Print("the scene creates more bodies than the physics bake holds");
+		matching = false;
+		return;
+	}
+	if (bodies[nextBody].assetShape != (int)asset->assetShape) {
+		Game::console.Print("body %d does not match the physics bake", (int)nextBody);
+		matching = false;
+		return;
+	}
+	assetBodies[asset] = nextBody++;
+}
+
+btCollisionShape * EPhysicsBake::Shape(Asset * asset)
+{
+	if (!loaded)
+		return nullptr;
+	auto found = assetBodies.find(asset);
+	if (found == assetBodies.end())
+		return nullptr;
+	const EBakedBody& baked = bodies[found->second];
+	vec3 size = asset->getScale() * asset->collisionSizeOffset;
+	if (baked.shape == nullptr || baked.size != size)
+		return nullptr;
+	// later assets of the model share the compound, like they would share the one the model builds
+	if (asset->assetShape == assetShapes::convexHulls && asset->collisionModel != nullptr && baked.shape->getShapeType() == COMPOUND_SHAPE_PROXYTYPE) {
+		asset->collisionModel->addCollisionShape(size, static_cast<btCompoundShape*>(baked.shape));
+	}
+	return baked.shape;
+}
+
+void EPhysicsBake::Restore(Asset * asset)
+{
+	if (!loaded)
+		return;
+	auto found = assetBodies.find(asset);
+	btRigidBody* body = asset->getRigidBody();
+	if (found == assetBodies.end() || body == nullptr)
+		return;
+	const EBakedBody& baked = bodies[found->second];
+
+	btVector3 inertia(0, 0, 0);
+	if (baked.mass > 0) {
+		body->getCollisionShape()->calculateLocalInertia(baked.mass, inertia);
+	}
+	body->setMassProps(baked.mass, inertia);
+	body->updateInertiaTensor();
+	asset->mass = baked.mass;
+	// after the mass, setMassProps sets or clears the static flag itself
+	body->setCollisionFlags(baked.collisionFlags);
+	body->setFriction(baked.friction);
+	body->setRestitution(baked.restitution);
+
+	body->setCenterOfMassTransform(baked.transform);
+	body->getMotionState()->setWorldTransform(baked.transform);
+	btVector3 origin = baked.transform.getOrigin();
+	btQuaternion rotation = baked.transform.getRotation();
+	asset->position = Game::toGlm(origin) - asset->collisionPosOffset;
+	asset->q = quat(rotation.getW(), rotation.getX(), rotation.getY(), rotation.getZ());
+}
+
+bool EPhysicsBake::Finish()
+{
+	if (!loaded)
+		return false;
+	bool complete = matching && nextBody == bodies.size();
+	// every body has to be the baked one, assets that got a new size built their own shape
+	for each (Asset* a in Game::nextAssets)
+	{
+		if (!complete)
+			break;
+		if (a->getRigidBody() == nullptr)
+			continue;
+		auto found = assetBodies.find(a);
+		if (found == assetBodies.end()) {
+			complete = false;
+		}
+		else if (bodies[found->second].shape != nullptr && bodies[found->second].shape != a->getRigidBody()->getCollisionShape()) {
+			complete = false;
+		}
+	}
+	if (!complete) {
+		Game::console.Print("the scene does not match the physics bake anymore");
+	}
+
+	loaded = false;
+	matching = false;
+	bodies.clear();
+	nextBody = 0;
+	assetBodies.clear();
+	return complete;
+}
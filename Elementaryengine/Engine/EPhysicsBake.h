@@ -0,0 +1,85 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+#include <map>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+class Asset;
+
+///<summary>
+///a body of a physics bake, in the order its asset was created
+///</summary>
+struct DllExport EBakedBody
+{
+	// assetShapes of the asset
+	int assetShape = 0;
+	// scale * collisionSizeOffset the shape was built for
+	vec3 size = vec3(0);
+	// nullptr if the shape type can not be loaded, the asset builds it itself then
+	btCollisionShape* shape = nullptr;
+	// body state at the time of the bake, restored onto the asset
+	btTransform transform = btTransform::getIdentity();
+	float mass = 0;
+	int collisionFlags = 0;
+	float friction = 0;
+	float restitution = 0;
+};
+
+///<summary>
+///level bake of the physics world. Bake writes all asset bodies with their collision shapes to a .bullet file with btDefaultSerializer,
+///Load reads it back with bParse and btCollisionWorldImporter, so the assets the scene creates take their shapes and body state from the file instead of decomposing models and building hulls.
+///The file is only valid for the build that wrote it (pointer size, endianness and bullet version are checked)
+///</summary>
+class DllExport EPhysicsBake
+{
+public:
+	///<summary>
+	///writes the shapes of all asset bodies, in creation order
+	///</summary>
+	static bool Bake(string path);
+
+	///<summary>
+	///reads a bake, the following assets get matched to its bodies in creation order. Call before the scene gets loaded
+	///</summary>
+	static bool Load(string path);
+
+	///<summary>
+	///true between Load and Finish
+	///</summary>
+	static bool Loaded();
+
+	///<summary>
+	///matches the next baked body to the asset, called when the asset creates its rigid body
+	///</summary>
+	static void Next(Asset* asset);
+
+	///<summary>
+	///the baked shape of the asset if it was baked with the shape type and size the asset has now, otherwise nullptr
+	///</summary>
+	static btCollisionShape* Shape(Asset* asset);
+
+	///<summary>
+	///writes the baked transform, mass, collision flags, friction and restitution onto the rigid body of the asset, called before the body enters the world
+	///</summary>
+	static void Restore(Asset* asset);
+
+	///<summary>
+	///stops matching assets. Call after the scene is loaded
+	///</summary>
+	///<returns>
+	///true if the scene created exactly the baked bodies, false if nothing was loaded or the bake is outdated
+	///</returns>
+	static bool Finish();
+
+private:
+	static bool loaded;
+	static bool matching;
+	static vector<EBakedBody> bodies;
+	static size_t nextBody;
+	static map<Asset*, size_t> assetBodies;
+};
@@ -0,0 +1,121 @@
+#include "EPhysicsBenchmark.h"
+#include <Game.h>
+#include <chrono>
+
+vector<EPhysicsBenchmarkResult> EPhysicsBenchmark::Run(const vector<int>& bodyCounts, int steps, float staticFraction)
+{
+	vector<EPhysicsBenchmarkResult> results;
+	EBroadphaseType broadphases[] = { dbvtBroadphase, axisSweepBroadphase, axisSweep32Broadphase };
+
+	printf("\nphysics benchmark, %i steps, %i%% static\n", steps, (int)(staticFraction * 100 + .5f));
+	printf("%-20s %8s %10s %10s %10s %10s\n", "broadphase", "bodies", "build ms", "step ms", "max ms", "pairs");
+	for each (int bodyCount in bodyCounts)
+	{
+		for each (EBroadphaseType broadphase in broadphases)
+		{
+			// the floor takes one handle too
+			if (broadphase == axisSweepBroadphase && bodyCount + 1 > 32766) {
+				printf("%-20s %8i %10s\n", EPhysicsWorld::Name(broadphase), bodyCount, "n/a");
+				continue;
+			}
+			EPhysicsBenchmarkResult r = RunScene(broadphase, bodyCount, steps, staticFraction);
+			printf("%-20s %8i %10.2f %10.3f %10.3f %10i\n", EPhysicsWorld::Name(broadphase), r.bodies, r.buildMs, r.averageStepMs, r.maxStepMs, r.pairs);
+			results.push_back(r);
+		}
+	}
+	return results;
+}
+
+EPhysicsBenchmarkResult EPhysicsBenchmark::RunScene(EBroadphaseType broadphase, int bodyCount, int steps, float staticFraction)
+{
+	typedef chrono::high_resolution_clock clock;
+
+	// same sizes as the placed blocks and balls of the BallDemo, the grid grows with the body count
+	const float blockSize = 0.25f;
+	// gap wider than the aabb margins, so neighbouring blocks do not pair up
+	const float spacing = 2 * blockSize + 0.1f;
+	int staticCount = (int)(bodyCount * staticFraction);
+	int dynamicCount = bodyCount - staticCount;
+	int side = (int)ceil(sqrt((float)glm::max(staticCount, dynamicCount) / 4.0f));
+	float halfWidth = side * spacing / 2 + 1;
+	// blocks are stacked four high, the balls fall from above them
+	float height = 8 * spacing + (dynamicCount / (side * side) + 1) * spacing * 2;
+
+	EPhysicsSettings settings;
+	settings.broadphase = broadphase;
+	settings.worldMin = vec3(-halfWidth, -2, -halfWidth);
+	settings.worldMax = vec3(halfWidth, height + 2, halfWidth);
+	settings.maxObjects = bodyCount + 1;
+	settings.softBodies = false;
+	btDiscreteDynamicsWorld* world = EPhysicsWorld::Create(settings);
+
+	btBoxShape* floorShape = new btBoxShape(btVector3(halfWidth, 0.5f, halfWidth));
+	btBoxShape* blockShape = new btBoxShape(btVector3(blockSize, blockSize, blockSize));
+	btSphereShape* ballShape = new btSphereShape(blockSize);
+	btVector3 ballInertia;
+	ballShape->calculateLocalInertia(1, ballInertia);
+	vector<btRigidBody*> bodies;
+	bodies.reserve(bodyCount + 1);
+
+	clock::time_point buildStart = clock::now();
+	btTransform transform;
+	transform.setIdentity();
+	transform.setOrigin(btVector3(0, -0.5f, 0));
+	bodies.push_back(new btRigidBody(0, nullptr, floorShape));
+	bodies.back()->setWorldTransform(transform);
+	world->addRigidBody(bodies.back(), ECollisionLayers::Group(ECollisionLayers::staticLayer), ECollisionLayers::Mask(ECollisionLayers::staticLayer));
+
+	for (int i = 0; i < staticCount; i++)
+	{
+		int layer = i / (side * side);
+		int cell = i % (side * side);
+		transform.setOrigin(btVector3((cell % side) * spacing - halfWidth + 1, blockSize + layer * spacing, (cell / side) * spacing - halfWidth + 1));
+		btRigidBody* block = new btRigidBody(0, nullptr, blockShape);
+		block->setWorldTransform(transform);
+		world->addRigidBody(block, ECollisionLayers::Group(ECollisionLayers::staticLayer), ECollisionLayers::Mask(ECollisionLayers::staticLayer));
+		bodies.push_back(block);
+	}
+
+	// fixed seed, every broadphase gets the same scene
+	unsigned int seed = 12345;
+	for (int i = 0; i < dynamicCount; i++)
+	{
+		int layer = i / (side * side);
+		int cell = i % (side * side);
+		seed = seed * 1664525 + 1013904223;
+		float jitter = ((seed >> 8) % 1000) / 1000.0f * 0.2f - 0.1f;
+		transform.setOrigin(btVector3((cell % side) * spacing - halfWidth + 1 + jitter, 8 * spacing + layer * spacing * 2, (cell / side) * spacing - halfWidth + 1 - jitter));
+		btRigidBody* ball = new btRigidBody(1, nullptr, ballShape, ballInertia);
+		ball->setWorldTransform(transform);
+		world->addRigidBody(ball, ECollisionLayers::Group(ECollisionLayers::defaultLayer), ECollisionLayers::Mask(ECollisionLayers::defaultLayer));
+		bodies.push_back(ball);
+	}
+
+	EPhysicsBenchmarkResult result;
+	result.broadphase = broadphase;
+	result.bodies = bodyCount;
+	result.buildMs = chrono::duration<double, milli>(clock::now() - buildStart).count();
+	result.maxStepMs = 0;
+
+	double total = 0;
+	for (int i = 0; i < steps; i++)
+	{
+		clock::time_point stepStart = clock::now();
+		world->stepSimulation(1.0f / 60.0f, 0);
+		double stepMs = chrono::duration<double, milli>(clock::now() - stepStart).count();
+		total += stepMs;
+		result.maxStepMs = glm::max(result.maxStepMs, stepMs);
+	}
+	result.averageStepMs = steps > 0 ? total / steps : 0;
+	result.pairs = world->getBroadphase()->getOverlappingPairCache()->getNumOverlappingPairs();
+
+	EPhysicsWorld::Destroy(world);
+	for each (btRigidBody* body in bodies)
+	{
+		delete body;
+	}
+	delete floorShape;
+	delete blockShape;
+	delete ballShape;
+	return result;
+}
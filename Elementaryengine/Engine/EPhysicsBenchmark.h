@@ -0,0 +1,40 @@
+#pragma once
+#include <EEngine.h>
+#include <EPhysicsWorld.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+struct DllExport EPhysicsBenchmarkResult
+{
+	EBroadphaseType broadphase;
+	int bodies;
+	// time to add all bodies to the world
+	double buildMs;
+	double averageStepMs;
+	double maxStepMs;
+	// broadphase pairs after the last step
+	int pairs;
+};
+
+///<summary>
+///headless physics benchmark: the BallDemo scene (static blocks on a floor, dynamic balls dropped onto them) scaled up and stepped with each broadphase
+///</summary>
+class DllExport EPhysicsBenchmark
+{
+public:
+	///<summary>
+	///runs every scene size with every broadphase and prints the step times as a table
+	///</summary>
+	///<param name="staticFraction">
+	///part of the bodies that are static blocks, the rest are dynamic balls
+	///</param>
+	static vector<EPhysicsBenchmarkResult> Run(const vector<int>& bodyCounts = { 1000, 10000, 50000 }, int steps = 300, float staticFraction = 0.8f);
+
+	///<summary>
+	///builds one scene in its own world, steps it with a fixed 60 Hz step and tears it down again
+	///</summary>
+	static EPhysicsBenchmarkResult RunScene(EBroadphaseType broadphase, int bodyCount, int steps, float staticFraction);
+};
@@ -0,0 +1,249 @@
+#include "EPhysicsQueries.h"
+#include <Game.h>
+#include <EJobSystem.h>
+#include <BulletCollision\NarrowPhaseCollision\btGjkEpa2.h>
+#include <BulletCollision\CollisionShapes\btTriangleShape.h>
+#include <BulletCollision\CollisionShapes\btTriangleCallback.h>
+
+// collects the asset bodies whose broadphase bounds touch the box, aabbTest uses its own stack so several threads can do this at once.
+// The physics thread changes the tree while it steps, the callers hold Game::physicsMutex
+struct AssetAabbCallback : public btBroadphaseAabbCallback
+{
+	AssetAabbCallback(int layerMask) : layerMask(layerMask) {}
+
+	virtual bool process(const btBroadphaseProxy* proxy)
+	{
+		if ((proxy->m_collisionFilterGroup & layerMask) == 0)
+			return true;
+		const btCollisionObject* object = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+		if (btRigidBody::upcast(object) != nullptr && object->getUserPointer() != nullptr) {
+			objects.push_back(object);
+		}
+		return true;
+	}
+
+	int layerMask;
+	vector<const btCollisionObject*> objects;
+};
+
+static vector<const btCollisionObject*> Candidates(const btVector3& aabbMin, const btVector3& aabbMax, int layerMask)
+{
+	AssetAabbCallback callback(layerMask);
+	Game::dynamicsWorld->getBroadphase()->aabbTest(aabbMin, aabbMax, callback);
+	return callback.objects;
+}
+
+static btTransform QueryTransform(vec3 position, quat rotation)
+{
+	return btTransform(btQuaternion(rotation.x, rotation.y, rotation.z, rotation.w), Game::toBullet(position));
+}
+
+static bool ConvexIntersects(const btConvexShape* a, const btTransform& transformA, const btConvexShape* b, const btTransform& transformB)
+{
+	btGjkEpaSolver2::sResults results;
+	btVector3 guess = transformB.getOrigin() - transformA.getOrigin();
+	// the cores already penetrate (or touch so closely that GJK gives up)
+	if (!btGjkEpaSolver2::Distance(a, transformA, b, transformB, guess, results))
+		return true;
+	// Distance ignores the margins, spheres are nothing but margin
+	return results.distance <= a->getMargin() + b->getMargin();
+}
+
+// tests the query shape against the triangles of a concave shape, stops at the first hit
+struct TriangleOverlapCallback : public btTriangleCallback
+{
+	TriangleOverlapCallback(const btConvexShape* shape, const btTransform& shapeTransform, const btTransform& meshTransform)
+		: shape(shape), shapeTransform(shapeTransform), meshTransform(meshTransform) {}
+
+	virtual void processTriangle(btVector3* triangle, int partId, int triangleIndex)
+	{
+		if (hit)
+			return;
+		btTriangleShape triangleShape(triangle[0], triangle[1], triangle[2]);
+		triangleShape.setMargin(0);
+		hit = ConvexIntersects(shape, shapeTransform, &triangleShape, meshTransform);
+	}
+
+	const btConvexShape* shape;
+	btTransform shapeTransform;
+	btTransform meshTransform;
+	bool hit = false;
+};
+
+static bool ShapeIntersects(const btConvexShape* shape, const btTransform& transform, const btCollisionShape* other, const btTransform& otherTransform)
+{
+	if (other->isConvex()) {
+		return ConvexIntersects(shape, transform, static_cast<const btConvexShape*>(other), otherTransform);
+	}
+	if (other->isCompound()) {
+		const btCompoundShape* compound = static_cast<const btCompoundShape*>(other);
+		btVector3 aabbMin, aabbMax;
+		shape->getAabb(transform, aabbMin, aabbMax);
+		for (int i = 0; i < compound->getNumChildShapes(); i++)
+		{
+			btTransform childTransform = otherTransform * compound->getChildTransform(i);
+			const btCollisionShape* child = compound->getChildShape(i);
+			btVector3 childMin, childMax;
+			child->getAabb(childTransform, childMin, childMax);
+			if (!TestAabbAgainstAabb2(aabbMin, aabbMax, childMin, childMax))
+				continue;
+			if (ShapeIntersects(shape, transform, child, childTransform))
+				return true;
+		}
+		return false;
+	}
+	if (other->isConcave()) {
+		// the triangles are returned in the local space of the mesh
+		btVector3 aabbMin, aabbMax;
+		shape->getAabb(otherTransform.inverse() * transform, aabbMin, aabbMax);
+		TriangleOverlapCallback callback(shape, transform, otherTransform);
+		static_cast<const btConcaveShape*>(other)->processAllTriangles(&callback, aabbMin, aabbMax);
+		return callback.hit;
+	}
+	return false;
+}
+
+bool EPhysicsQueries::Intersects(const btConvexShape * shape, const btTransform & transform, const btCollisionObject * object)
+{
+	return ShapeIntersects(shape, transform, object->getCollisionShape(), object->getWorldTransform());
+}
+
+static vector<Asset*> OverlapShape(const btConvexShape* shape, const btTransform& transform, int layerMask)
+{
+	vector<Asset*> result;
+	btVector3 aabbMin, aabbMax;
+	shape->getAabb(transform, aabbMin, aabbMax);
+	vector<const btCollisionObject*> candidates = Candidates(aabbMin, aabbMax, layerMask);
+	for each (const btCollisionObject* object in candidates)
+	{
+		if (EPhysicsQueries::Intersects(shape, transform, object)) {
+			result.push_back(static_cast<Asset*>(object->getUserPointer()));
+		}
+	}
+	return result;
+}
+
+static RayCastHit SweepShape(const btConvexShape* shape, const btTransform& from, const btTransform& to, int layerMask)
+{
+	RayCastHit hit;
+	// everything the shape can touch on its way
+	btVector3 aabbMin, aabbMax, endMin, endMax;
+	shape->getAabb(from, aabbMin, aabbMax);
+	shape->getAabb(to, endMin, endMax);
+	aabbMin.setMin(endMin);
+	aabbMax.setMax(endMax);
+
+	btCollisionWorld::ClosestConvexResultCallback callback(from.getOrigin(), to.getOrigin());
+	vector<const btCollisionObject*> candidates = Candidates(aabbMin, aabbMax, layerMask);
+	for each (const btCollisionObject* object in candidates)
+	{
+		// objectQuerySingle only keeps hits closer than the current closest one
+		btCollisionWorld::objectQuerySingle(shape, from, to, const_cast<btCollisionObject*>(object), object->getCollisionShape(), object->getWorldTransform(), callback, 0);
+	}
+	if (callback.hasHit()) {
+		hit.hitAsset = static_cast<Asset*>(callback.m_hitCollisionObject->getUserPointer());
+		hit.hitPos = Game::toGlm(callback.m_hitPointWorld);
+		hit.hitNormal = Game::toGlm(callback.m_hitNormalWorld.normalized());
+	}
+	return hit;
+}
+
+static vector<Asset*> OverlapUnlocked(const EShapeQuery& query)
+{
+	btTransform transform = QueryTransform(query.position, query.rotation);
+	if (query.shape == querySphere) {
+		btSphereShape sphere(query.radius);
+		return OverlapShape(&sphere, transform, query.layerMask);
+	}
+	btBoxShape box(Game::toBullet(query.halfExtents));
+	return OverlapShape(&box, transform, query.layerMask);
+}
+
+static RayCastHit SweepUnlocked(const EShapeQuery& query)
+{
+	btTransform from = QueryTransform(query.position, query.rotation);
+	btTransform to = QueryTransform(query.end, query.rotation);
+	if (query.shape == querySphere) {
+		btSphereShape sphere(query.radius);
+		return SweepShape(&sphere, from, to, query.layerMask);
+	}
+	btBoxShape box(Game::toBullet(query.halfExtents));
+	return SweepShape(&box, from, to, query.layerMask);
+}
+
+vector<Asset*> EPhysicsQueries::Overlap(const EShapeQuery & query)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	return OverlapUnlocked(query);
+}
+
+RayCastHit EPhysicsQueries::Sweep(const EShapeQuery & query)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	return SweepUnlocked(query);
+}
+
+// the whole batch runs under one lock, the jobs only read
+vector<vector<Asset*>> EPhysicsQueries::OverlapBatch(const vector<EShapeQuery>& queries)
+{
+	vector<vector<Asset*>> results(queries.size());
+	lock_guard<mutex> lock(Game::physicsMutex);
+	EJobSystem::ParallelFor((unsigned int)queries.size(), [&](unsigned int i) {
+		results[i] = OverlapUnlocked(queries[i]);
+	});
+	return results;
+}
+
+vector<RayCastHit> EPhysicsQueries::SweepBatch(const vector<EShapeQuery>& queries)
+{
+	vector<RayCastHit> results(queries.size());
+	lock_guard<mutex> lock(Game::physicsMutex);
+	EJobSystem::ParallelFor((unsigned int)queries.size(), [&](unsigned int i) {
+		results[i] = SweepUnlocked(queries[i]);
+	});
+	return results;
+}
+
+vector<Asset*> EPhysicsQueries::OverlapSphere(vec3 center, float radius, int layerMask)
+{
+	EShapeQuery query;
+	query.shape = querySphere;
+	query.position = center;
+	query.radius = radius;
+	query.layerMask = layerMask;
+	return Overlap(query);
+}
+
+vector<Asset*> EPhysicsQueries::OverlapBox(vec3 center, vec3 halfExtents, quat rotation, int layerMask)
+{
+	EShapeQuery query;
+	query.shape = queryBox;
+	query.position = center;
+	query.halfExtents = halfExtents;
+	query.rotation = rotation;
+	query.layerMask = layerMask;
+	return Overlap(query);
+}
+
+RayCastHit EPhysicsQueries::SweepSphere(vec3 start, vec3 end, float radius, int layerMask)
+{
+	EShapeQuery query;
+	query.shape = querySphere;
+	query.position = start;
+	query.end = end;
+	query.radius = radius;
+	query.layerMask = layerMask;
+	return Sweep(query);
+}
+
+RayCastHit EPhysicsQueries::SweepBox(vec3 start, vec3 end, vec3 halfExtents, quat rotation, int layerMask)
+{
+	EShapeQuery query;
+	query.shape = queryBox;
+	query.position = start;
+	query.end = end;
+	query.halfExtents = halfExtents;
+	query.rotation = rotation;
+	query.layerMask = layerMask;
+	return Sweep(query);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <EEngine.h>
+#include <RayCastHit.h>
+#include <ECollisionLayers.h>
+#include <btBulletDynamicsCommon.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+enum EQueryShape { querySphere, queryBox };
+
+///<summary>
+///a sphere or an oriented box for overlap and sweep queries. Sweeps move it from position to end
+///</summary>
+struct DllExport EShapeQuery
+{
+	EQueryShape shape = querySphere;
+	vec3 position = vec3(0);
+	vec3 end = vec3(0);
+	// sphere
+	float radius = 0.5f;
+	// box
+	vec3 halfExtents = vec3(0.5f);
+	quat rotation = quat(1, 0, 0, 0);
+	// only assets on these layers are found
+	int layerMask = ECollisionLayers::allLayers;
+};
+
+///<summary>
+///shape queries against the physics world. They only read the broadphase tree and run their own narrowphase, so a batch can be spread over the job system.
+///Only assets are reported, trigger volumes are ignored. The queries lock Game::physicsMutex, don't call them while holding it
+///</summary>
+class DllExport EPhysicsQueries
+{
+public:
+	///<summary>
+	///all assets that intersect the shape
+	///</summary>
+	static vector<Asset*> Overlap(const EShapeQuery& query);
+
+	///<summary>
+	///first asset the shape hits on its way from position to end. hitAsset is nullptr if nothing was hit
+	///</summary>
+	static RayCastHit Sweep(const EShapeQuery& query);
+
+	///<summary>
+	///runs the overlaps in parallel, the results are in the order of the queries
+	///</summary>
+	static vector<vector<Asset*>> OverlapBatch(const vector<EShapeQuery>& queries);
+
+	///<summary>
+	///runs the sweeps in parallel, the results are in the order of the queries
+	///</summary>
+	static vector<RayCastHit> SweepBatch(const vector<EShapeQuery>& queries);
+
+	static vector<Asset*> OverlapSphere(vec3 center, float radius, int layerMask = ECollisionLayers::allLayers);
+	static vector<Asset*> OverlapBox(vec3 center, vec3 halfExtents, quat rotation, int layerMask = ECollisionLayers::allLayers);
+	static RayCastHit SweepSphere(vec3 start, vec3 end, float radius, int layerMask = ECollisionLayers::allLayers);
+	static RayCastHit SweepBox(vec3 start, vec3 end, vec3 halfExtents, quat rotation, int layerMask = ECollisionLayers::allLayers);
+
+	///<summary>
+	///narrowphase test of a convex shape against a collision object (convex, compound or triangle mesh)
+	///</summary>
+	static bool Intersects(const btConvexShape* shape, const btTransform& transform, const btCollisionObject* object);
+};
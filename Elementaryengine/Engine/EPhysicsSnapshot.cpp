@@ -0,0 +1,167 @@
+#include "EPhysicsSnapshot.h"
+#include <Game.h>
+#include <unordered_set>
+#include <cstring>
+
+void EPhysicsSnapshot::Capture()
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	CaptureUnlocked();
+}
+
+void EPhysicsSnapshot::Restore()
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	RestoreUnlocked();
+}
+
+void EPhysicsSnapshot::CaptureUnlocked()
+{
+	btCollisionObjectArray& objects = Game::dynamicsWorld->getCollisionObjectArray();
+	bodies.clear();
+	bodies.reserve(objects.size());
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btRigidBody* body = btRigidBody::upcast(objects[i]);
+		if (body == nullptr)
+			continue;
+		BodyState state;
+		state.body = body;
+		state.transform = body->getCenterOfMassTransform();
+		state.linearVelocity = body->getLinearVelocity();
+		state.angularVelocity = body->getAngularVelocity();
+		state.activationState = body->getActivationState();
+		state.deactivationTime = body->getDeactivationTime();
+		bodies.push_back(state);
+	}
+}
+
+void EPhysicsSnapshot::RestoreUnlocked()
+{
+	btDiscreteDynamicsWorld* world = Game::dynamicsWorld;
+	btCollisionObjectArray& objects = world->getCollisionObjectArray();
+
+	// destroyed assets deleted their bodies, never touch those
+	unordered_set<btCollisionObject*> alive;
+	for (int i = 0; i < objects.size(); i++)
+	{
+		alive.insert(objects[i]);
+	}
+
+	for each (BodyState state in bodies)
+	{
+		if (alive.count(state.body) == 0)
+			continue;
+		btRigidBody* body = state.body;
+		body->clearForces();
+		body->setLinearVelocity(state.linearVelocity);
+		body->setAngularVelocity(state.angularVelocity);
+		// also sets the interpolation transform and velocities and the world inertia, like the end of a step does
+		body->setCenterOfMassTransform(state.transform);
+		body->forceActivationState(state.activationState);
+		body->setDeactivationTime(state.deactivationTime);
+		body->setHitFraction(1);
+		// kinematic bodies read it back, all others get synced to the renderer
+		if (body->getMotionState() != nullptr) {
+			body->getMotionState()->setWorldTransform(state.transform);
+		}
+	}
+
+	ResetCollisionState(world);
+}
+
+void EPhysicsSnapshot::ResetCollisionState(btDiscreteDynamicsWorld * world)
+{
+	btBroadphaseInterface* broadphase = world->getBroadphase();
+	btDispatcher* dispatcher = world->getDispatcher();
+	btCollisionObjectArray& objects = world->getCollisionObjectArray();
+
+	EPhysicsWorld::ClearPairs(world);
+
+	vector<int> groups(objects.size());
+	vector<int> masks(objects.size());
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btBroadphaseProxy* proxy = objects[i]->getBroadphaseHandle();
+		if (proxy == nullptr)
+			continue;
+		groups[i] = proxy->m_collisionFilterGroup;
+		masks[i] = proxy->m_collisionFilterMask;
+		broadphase->destroyProxy(proxy, dispatcher);
+		objects[i]->setBroadphaseHandle(nullptr);
+	}
+
+	// the broadphase is empty now, this also restarts the proxy ids
+	broadphase->resetPool(dispatcher);
+	world->getConstraintSolver()->reset();
+
+	for (int i = 0; i < objects.size(); i++)
+	{
+		btCollisionObject* object = objects[i];
+		btVector3 aabbMin, aabbMax;
+		object->getCollisionShape()->getAabb(object->getWorldTransform(), aabbMin, aabbMax);
+		object->setBroadphaseHandle(broadphase->createProxy(aabbMin, aabbMax, object->getCollisionShape()->getShapeType(), object, groups[i], masks[i], dispatcher));
+	}
+}
+
+// compares x, y and z only, w of a btVector3 is padding
+static bool SameBits(const btVector3& a, const btVector3& b)
+{
+	return memcmp(a.m_floats, b.m_floats, 3 * sizeof(btScalar)) == 0;
+}
+
+bool EPhysicsSnapshot::Equals(const EPhysicsSnapshot & other) const
+{
+	if (bodies.size() != other.bodies.size())
+		return false;
+	for (unsigned int i = 0; i < bodies.size(); i++)
+	{
+		const BodyState& a = bodies[i];
+		const BodyState& b = other.bodies[i];
+		if (a.body != b.body || a.activationState != b.activationState)
+			return false;
+		if (!SameBits(a.transform.getOrigin(), b.transform.getOrigin()))
+			return false;
+		for (int row = 0; row < 3; row++)
+		{
+			if (!SameBits(a.transform.getBasis()[row], b.transform.getBasis()[row]))
+				return false;
+		}
+		if (!SameBits(a.linearVelocity, b.linearVelocity) || !SameBits(a.angularVelocity, b.angularVelocity))
+			return false;
+		if (memcmp(&a.deactivationTime, &b.deactivationTime, sizeof(btScalar)) != 0)
+			return false;
+	}
+	return true;
+}
+
+unsigned int EPhysicsSnapshot::BodyCount() const
+{
+	return (unsigned int)bodies.size();
+}
+
+bool EPhysicsSnapshot::VerifyReplay(int steps, btScalar timeStep)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	// both runs cover the same steps, their events would reach the scripts twice
+	ECollisionEvents::muted = true;
+	EPhysicsSnapshot start, first, second;
+	start.CaptureUnlocked();
+
+	start.RestoreUnlocked();
+	for (int i = 0; i < steps; i++)
+	{
+		Game::dynamicsWorld->stepSimulation(timeStep, 0);
+	}
+	first.CaptureUnlocked();
+
+	start.RestoreUnlocked();
+	for (int i = 0; i < steps; i++)
+	{
+		Game::dynamicsWorld->stepSimulation(timeStep, 0);
+	}
+	second.CaptureUnlocked();
+	ECollisionEvents::muted = false;
+
+	return first.Equals(second);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+
+///<summary>
+///copy of the state of every rigid body in the physics world (transform, velocities, activation). Restoring also resets the broadphase and the contact caches,
+///so stepping the same way after a restore always gives bit identical results in the fixed timestep mode
+///</summary>
+class DllExport EPhysicsSnapshot
+{
+public:
+	///<summary>
+	///captures all rigid bodies of Game::dynamicsWorld
+	///</summary>
+	void Capture();
+
+	///<summary>
+	///writes the captured state back. Bodies removed since the capture are skipped, bodies added since keep their state. Pending forces are dropped
+	///</summary>
+	void Restore();
+
+	///<summary>
+	///true if both snapshots hold the same bodies with bit identical state
+	///</summary>
+	bool Equals(const EPhysicsSnapshot& other) const;
+
+	unsigned int BodyCount() const;
+
+	///<summary>
+	///self check: restores, steps, restores again and steps again with the fixed timestep, true if both runs end bit identical. The world is left at the end state.
+	///The check steps send no collision or trigger events
+	///</summary>
+	static bool VerifyReplay(int steps, btScalar timeStep);
+
+private:
+	struct BodyState
+	{
+		btRigidBody* body;
+		btTransform transform;
+		btVector3 linearVelocity;
+		btVector3 angularVelocity;
+		int activationState;
+		btScalar deactivationTime;
+	};
+
+	vector<BodyState> bodies;
+
+	void CaptureUnlocked();
+	void RestoreUnlocked();
+
+	///<summary>
+	///drops all broadphase pairs and contact manifolds and reinserts the objects in world order, so the pairs come out in the same order every time
+	///</summary>
+	static void ResetCollisionState(btDiscreteDynamicsWorld* world);
+};
@@ -0,0 +1,117 @@
+#include "EPhysicsWorld.h"
+#include <Game.h>
+#include <BulletCollision\CollisionDispatch\btGhostObject.h>
+#include <BulletSoftBody\btSoftBodyRigidBodyCollisionConfiguration.h>
+#include <ESoftBody.h>
+#include <map>
+
+// stateless, so every world can share it
+static btGhostPairCallback ghostPairCallback;
+
+// the soft body world does not hand out its solver, Destroy looks it up here
+static map<btDiscreteDynamicsWorld*, ESoftBodySolver*> softBodySolvers;
+
+btDiscreteDynamicsWorld * EPhysicsWorld::Create(const EPhysicsSettings & settings)
+{
+	btBroadphaseInterface* broadphase = CreateBroadphase(settings);
+	btDefaultCollisionConfiguration* collisionConfiguration = settings.softBodies ? new btSoftBodyRigidBodyCollisionConfiguration() : new btDefaultCollisionConfiguration();
+	btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
+	btGImpactCollisionAlgorithm::registerAlgorithm(dispatcher);
+	btSequentialImpulseConstraintSolver* solver = new btSequentialImpulseConstraintSolver;
+	btDiscreteDynamicsWorld* world;
+	if (settings.softBodies) {
+		ESoftBodySolver* softBodySolver = new ESoftBodySolver();
+		btSoftRigidDynamicsWorld* softWorld = new btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration, softBodySolver);
+		softWorld->getWorldInfo().m_gravity = Game::toBullet(settings.gravity);
+		softBodySolvers[softWorld] = softBodySolver;
+		world = softWorld;
+	}
+	else {
+		world = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+	}
+	world->setGravity(Game::toBullet(settings.gravity));
+	// keeps the pair caches of the trigger volumes up to date
+	broadphase->getOverlappingPairCache()->setInternalGhostPairCallback(&ghostPairCallback);
+	return world;
+}
+
+btBroadphaseInterface * EPhysicsWorld::CreateBroadphase(const EPhysicsSettings & settings)
+{
+	btVector3 worldMin = Game::toBullet(settings.worldMin);
+	btVector3 worldMax = Game::toBullet(settings.worldMax);
+	switch (settings.broadphase)
+	{
+	case axisSweepBroadphase:
+		// handle 0 and the last one are sentinels
+		if (settings.maxObjects <= 32766) {
+			return new btAxisSweep3(worldMin, worldMax, (unsigned short)settings.maxObjects);
+		}
+		Game::console.Print("btAxisSweep3 holds at most 32766 objects, using bt32BitAxisSweep3");
+		return new bt32BitAxisSweep3(worldMin, worldMax, settings.maxObjects);
+	case axisSweep32Broadphase:
+		return new bt32BitAxisSweep3(worldMin, worldMax, settings.maxObjects);
+	default:
+		return new btDbvtBroadphase();
+	}
+}
+
+void EPhysicsWorld::Destroy(btDiscreteDynamicsWorld * world)
+{
+	btBroadphaseInterface* broadphase = world->getBroadphase();
+	btCollisionDispatcher* dispatcher = static_cast<btCollisionDispatcher*>(world->getDispatcher());
+	btCollisionConfiguration* collisionConfiguration = dispatcher->getCollisionConfiguration();
+	btConstraintSolver* solver = world->getConstraintSolver();
+
+	// without proxies the world does not touch the objects when it is deleted, they are owned by their assets
+	ClearPairs(world);
+	btCollisionObjectArray& objects = world->getCollisionObjectArray();
+	for (int i = 0; i < objects.size(); i++)
+	{
+		if (objects[i]->getBroadphaseHandle() != nullptr) {
+			broadphase->destroyProxy(objects[i]->getBroadphaseHandle(), dispatcher);
+			objects[i]->setBroadphaseHandle(nullptr);
+		}
+	}
+	btSoftRigidDynamicsWorld* softWorld = dynamic_cast<btSoftRigidDynamicsWorld*>(world);
+	if (softWorld != nullptr) {
+		// the sparse sdf does not free its cells itself
+		softWorld->getWorldInfo().m_sparsesdf.Reset();
+	}
+	ESoftBodySolver* softBodySolver = nullptr;
+	auto found = softBodySolvers.find(world);
+	if (found != softBodySolvers.end()) {
+		softBodySolver = found->second;
+		softBodySolvers.erase(found);
+	}
+	delete world;
+	delete softBodySolver;
+	delete solver;
+	delete dispatcher;
+	delete collisionConfiguration;
+	delete broadphase;
+}
+
+void EPhysicsWorld::ClearPairs(btCollisionWorld * world)
+{
+	// removing from the back is constant time
+	btOverlappingPairCache* pairCache = world->getBroadphase()->getOverlappingPairCache();
+	btBroadphasePairArray& pairs = pairCache->getOverlappingPairArray();
+	while (pairs.size() > 0)
+	{
+		btBroadphasePair& pair = pairs[pairs.size() - 1];
+		pairCache->removeOverlappingPair(pair.m_pProxy0, pair.m_pProxy1, world->getDispatcher());
+	}
+}
+
+const char * EPhysicsWorld::Name(EBroadphaseType broadphase)
+{
+	switch (broadphase)
+	{
+	case axisSweepBroadphase:
+		return "btAxisSweep3";
+	case axisSweep32Broadphase:
+		return "bt32BitAxisSweep3";
+	default:
+		return "btDbvtBroadphase";
+	}
+}
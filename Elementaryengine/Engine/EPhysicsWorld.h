@@ -0,0 +1,54 @@
+#pragma once
+#include <EEngine.h>
+#include <btBulletDynamicsCommon.h>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+///<summary>
+///broadphase algorithms. The sweep and prune variants need the world bounds and are fastest for mostly static worlds,
+///the 16 bit one holds up to 32766 objects
+///</summary>
+enum EBroadphaseType { dbvtBroadphase, axisSweepBroadphase, axisSweep32Broadphase };
+
+///<summary>
+///settings of the physics world, permanent after Game::Start()
+///</summary>
+struct DllExport EPhysicsSettings
+{
+	EBroadphaseType broadphase = dbvtBroadphase;
+	// bounds for the sweep and prune broadphases, objects outside still work but get slow
+	vec3 worldMin = vec3(-1000);
+	vec3 worldMax = vec3(1000);
+	// object capacity of the sweep and prune broadphases
+	unsigned int maxObjects = 16384;
+	vec3 gravity = vec3(0, -9.8f, 0);
+	// creates a btSoftRigidDynamicsWorld that can hold ESoftBody components
+	bool softBodies = true;
+};
+
+///<summary>
+///creates and destroys dynamics worlds with everything they own
+///</summary>
+class DllExport EPhysicsWorld
+{
+public:
+	static btDiscreteDynamicsWorld* Create(const EPhysicsSettings& settings);
+
+	static btBroadphaseInterface* CreateBroadphase(const EPhysicsSettings& settings);
+
+	///<summary>
+	///deletes the world with its broadphase, dispatcher, solver and configuration. The objects stay alive but are in no world anymore
+	///</summary>
+	static void Destroy(btDiscreteDynamicsWorld* world);
+
+	///<summary>
+	///removes all broadphase pairs with their contact manifolds. Much faster than letting every removed proxy search the pairs
+	///</summary>
+	static void ClearPairs(btCollisionWorld* world);
+
+	static const char* Name(EBroadphaseType broadphase);
+};
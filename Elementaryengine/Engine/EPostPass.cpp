@@ -1,5 +1,6 @@
 #include "EPostPass.h"
 #include <Game.h>
+#include <cstring>
 
 
 
@@ -26,6 +27,18 @@ EPostPass::~EPostPass()
 
 void EPostPass::Render()
 {
+	BuildUI();
+
+	// the blur of all panels samples one pyramid, it is only built when a panel blurs its background
+	bool blurred = false;
+	for each (ERendererUIElement e in ERUIElements)
+	{
+		blurred |= e.backgoundBlur != 0;
+	}
+	if (blurred) {
+		buildBlurPyramid();
+	}
+
 	ERenderPass::Render();
 	//post fx (ssr) 
 	glBlitFramebuffer(0, 0, displaySettings->windowWidth, displaySettings->windowHeight, 0, 0, displaySettings->windowWidth, displaySettings->windowHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
@@ -63,8 +76,9 @@ void EPostPass::Render()
 	glActiveTexture(GL_TEXTURE6);
 	glBindTexture(GL_TEXTURE_2D, DepthBuffer);
 
-
-	BuildUI();
+	glActiveTexture(GL_TEXTURE0 + blurTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, blurPyramid);
+	glActiveTexture(GL_TEXTURE0);
 
 	Game::eOpenGl->renderQuad();
 
@@ -86,6 +100,7 @@ void EPostPass::Initialize()
 	_uniforms.push_back(new EOGLUniform<float>(_shader, "far_plane", 25.0f));
 	_uniforms.push_back(new EOGLUniform<int>(_shader, "gColor", 5));
 	_uniforms.push_back(new EOGLUniform<int>(_shader, "textures", 0));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "blurLevels", blurTextureUnit));
 
 	_uniforms.push_back(new EOGLUniform<vec3>(_shader, "viewPos",	[](){return Game::activeCam->position; }));
 	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "view",		[](){return Game::View; }));
@@ -96,10 +111,19 @@ void EPostPass::Initialize()
 	_uniforms.push_back(new EOGLUniform<int>(_shader, "screenY",	[](){return Game::displaySettings->windowHeight; }));
 
 	ERenderPass::Initialize();
-	glGenBuffers(1, &uiElementsSSBO);
-
-
 
+	binShader = new Shader("..\\shaders\\UIBin.comp");
+	uniformBinScreenX = EOGLUniform<int>(binShader, "screenX", 0);
+	uniformBinScreenY = EOGLUniform<int>(binShader, "screenY", 0);
+	uniformBinTilesX = EOGLUniform<int>(binShader, "tilesX", 0);
+	uniformBinElementCount = EOGLUniform<int>(binShader, "elementCount", 0);
+	glGenBuffers(1, &tileBuffer);
+
+	blurShader = new Shader("..\\shaders\\Blur.comp");
+	blurShader->use();
+	blurShader->setInt("source", 0);
+	uniformBlurStage = EOGLUniform<int>(blurShader, "stage", 0);
+	uniformBlurSourceLevel = EOGLUniform<int>(blurShader, "sourceLevel", 0);
 }
 
 void EPostPass::BuildUI()
@@ -123,9 +147,98 @@ void EPostPass::BuildUI()
 		u.z = uie->zindex;
 		ERUIElements.push_back(u);
 	}
+	// the buffer and the tiles stay as they are while nothing changed
+	int width = displaySettings->windowWidth;
+	int height = displaySettings->windowHeight;
+	bool changed = ERUIElements.size() != uploadedUIElements.size()
+		|| (!ERUIElements.empty() && memcmp(ERUIElements.data(), uploadedUIElements.data(), sizeof(ERendererUIElement) * ERUIElements.size()) != 0);
+	bool resized = width != binnedWidth || height != binnedHeight;
+	if (!changed && !resized) {
+		return;
+	}
+
 	// copy the atribute vector to the GPU
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, uiElementsSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ERendererUIElement) * ERUIElements.size(), ERUIElements.data(), GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	if (changed) {
+		Game::eOpenGl->uiElementsSSBO.Write(ERUIElements.data(), sizeof(ERendererUIElement) * ERUIElements.size(), 7);
+		uploadedUIElements = ERUIElements;
+	}
 
+	int tilesX = (width + uiTileSize - 1) / uiTileSize;
+	int tilesY = (height + uiTileSize - 1) / uiTileSize;
+	if (resized) {
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, tilesX * tilesY * (uiTileElements + 1) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, uiTileBinding, tileBuffer);
+		binnedWidth = width;
+		binnedHeight = height;
+	}
+
+	// sort the elements into the tiles
+	binShader->use();
+	uniformBinScreenX.Update(width);
+	uniformBinScreenY.Update(height);
+	uniformBinTilesX.Update(tilesX);
+	uniformBinElementCount.Update((int)ERUIElements.size());
+	glDispatchCompute(tilesX * tilesY, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+}
+
+void EPostPass::buildBlurPyramid()
+{
+	int width = (std::max)(1, displaySettings->windowWidth / 2);
+	int height = (std::max)(1, displaySettings->windowHeight / 2);
+	if (width != blurWidth || height != blurHeight) {
+		blurWidth = width;
+		blurHeight = height;
+		blurLevelCount = 1;
+		while (blurLevelCount < blurLevels && (std::max)(width, height) >> blurLevelCount > 0)
+		{
+			blurLevelCount++;
+		}
+		glDeleteTextures(1, &blurPyramid);
+		glDeleteTextures(1, &blurTemporary);
+		GLuint* textures[2] = { &blurPyramid, &blurTemporary };
+		for (int i = 0; i < 2; i++)
+		{
+			glGenTextures(1, textures[i]);
+			glBindTexture(GL_TEXTURE_2D, *textures[i]);
+			glTexStorage2D(GL_TEXTURE_2D, blurLevelCount, GL_RGBA16F, width, height);
+			// the ui blends between the levels for blur radii between them
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	// every level is the one before downsampled, then blurred horizontally into the temporary and vertically back
+	blurShader->use();
+	for (int level = 0; level < blurLevelCount; level++)
+	{
+		if (level == 0) {
+			blurStage(0, ColorBuffer, 0, blurPyramid, 0);
+		}
+		else {
+			blurStage(0, blurPyramid, level - 1, blurPyramid, level);
+		}
+		blurStage(1, blurPyramid, level, blurTemporary, level);
+		blurStage(2, blurTemporary, level, blurPyramid, level);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+void EPostPass::blurStage(int stage, GLuint source, int sourceLevel, GLuint destination, int level)
+{
+	uniformBlurStage.Update(stage);
+	uniformBlurSourceLevel.Update(sourceLevel);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, source);
+	glBindImageTexture(0, destination, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+	int width = (std::max)(1, blurWidth >> level);
+	int height = (std::max)(1, blurHeight >> level);
+	glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 }
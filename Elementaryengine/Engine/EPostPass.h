@@ -19,11 +19,49 @@ public:
 	GLuint ColorBuffer;
 	GLuint DepthBuffer;
 
-	GLuint uiElementsSSBO;
+	// the ui elements are sorted into tiles of uiTileSize pixels with up to uiTileElements elements each
+	static const int uiTileSize = 16;
+	static const int uiTileElements = 32;
+	static const int uiTileBinding = 25;
+
+	// levels of the blur pyramid of the ui background blur, the first is half the window size
+	static const int blurLevels = 6;
+	static const int blurTextureUnit = 7;
 
 private:
+	///<summary>
+	///copies the ui elements to the GPU and sorts them into the tiles, only if they changed or the window was resized
+	///</summary>
 	void BuildUI();
 	vector<ERendererUIElement> ERUIElements;
+	// the elements the buffer and the tiles were last built from
+	vector<ERendererUIElement> uploadedUIElements;
+
+	Shader* binShader;
+	EOGLUniform<int> uniformBinScreenX;
+	EOGLUniform<int> uniformBinScreenY;
+	EOGLUniform<int> uniformBinTilesX;
+	EOGLUniform<int> uniformBinElementCount;
+	GLuint tileBuffer = 0;
+	int binnedWidth = 0;
+	int binnedHeight = 0;
+
+	///<summary>
+	///downsamples the lit frame into the blur pyramid and blurs every level with a separable gaussian, (re)creates the textures when the window was resized
+	///</summary>
+	void buildBlurPyramid();
+	// runs one stage of the blur shader from a level of source into a level of destination
+	void blurStage(int stage, GLuint source, int sourceLevel, GLuint destination, int level);
+
+	Shader* blurShader;
+	EOGLUniform<int> uniformBlurStage;
+	EOGLUniform<int> uniformBlurSourceLevel;
+	// the blurred levels and the horizontally blurred temporaries of the same size
+	GLuint blurPyramid = 0;
+	GLuint blurTemporary = 0;
+	int blurWidth = 0;
+	int blurHeight = 0;
+	int blurLevelCount = 0;
 
 };
 
@@ -51,6 +51,7 @@ void ERasterizer::Setup(EOpenGl * eOpenGl, EDisplaySettings * displaySettings)
 	glGenBuffers(1, &eOpenGl->gElementBuffer);
 	glGenBuffers(1, &eOpenGl->gIndirectBuffer);
 	glGenBuffers(1, &eOpenGl->gVertexBuffer);
+	eOpenGl->geometryPool.Setup(eOpenGl->gVertexBuffer, eOpenGl->gElementBuffer);
 
 	Asset::rendererAssetCreatedCallback = &AssetCreatedCallback;
 	Asset::rendererAssetChangedCallback = &AssetChangedCallback;
@@ -91,6 +92,7 @@ Texture* ERasterizer::loadTexture(const char * path)
 void ERasterizer::AssetCreatedCallback(Asset * asset)
 {
 	assetCreated = true;
+	EShadowCache::InvalidateAll();
 }
 
 void ERasterizer::AssetChangedCallback(Asset * asset)
@@ -103,11 +105,13 @@ void ERasterizer::AssetChangedCallback(Asset * asset)
 		}
 	}
 	if(c)assetChanged = true;
+	EShadowCache::AssetChanged(asset);
 }
 
 void ERasterizer::AssetDestroyedCallback(Asset * asset)
 {
 	assetCreated = true;
+	EShadowCache::InvalidateAll();
 }
 
 
@@ -115,33 +119,21 @@ void ERasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpenGl* eOp
 {
 	// see if new mesh is loaded or new asset is created
 	if (meshChanged || assetsChanged) {
-		// clear the composed Mesh if needed
-		if (meshChanged) {
-			eOpenGl->vVertex.clear();
-			eOpenGl->vVertex.resize(0);
-			eOpenGl->gIndex.clear();
-			eOpenGl->gIndex.resize(0);
-		}
 		// clear the draw command buffer if needed
 		if (assetsChanged || meshChanged) {
 			eOpenGl->dICommands.clear();
 			eOpenGl->dICommands.resize(0);
 			eOpenGl->drawInstanceOffset.clear();
 			eOpenGl->drawInstanceOffset.push_back(0);
-			eOpenGl->currentIndexOffset = 0;
 			eOpenGl->currentVertexOffset = 0;
 			eOpenGl->instance = 0;
 		}
 		// redo mesh array
 		for each (Mesh* m in Game::meshs) {
 
-			// only need to add the mesh to the composed mesh if the composed mesh needs rebuilding
+			// new meshes get their ranges in the geometry pool, only they are uploaded
 			if (meshChanged) {
-				// Append indices
-				eOpenGl->gIndex.insert(eOpenGl->gIndex.end(), m->indices.begin(), m->indices.end());
-
-				// Append vertices
-				eOpenGl->vVertex.insert(eOpenGl->vVertex.end(), m->vertices.begin(), m->vertices.end());
+				eOpenGl->geometryPool.Add(m);
 			}
 			// create a new draw command
 			DrawElementsIndirectCommand c = DrawElementsIndirectCommand();
@@ -158,19 +150,17 @@ void ERasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpenGl* eOp
 			parentcount = (parentcount > 0) ? parentcount - 1 : -1;
 			eOpenGl->drawInstanceOffset.push_back(lastoffset + parentcount);
 
-			// first index of the composed mesh that belongs to the current mesh
-			c.firstIndex = eOpenGl->currentIndexOffset;
+			// first index of the geometry pool that belongs to the current mesh
+			c.firstIndex = m->indexOffset;
 
-			// first vertex of the composed mesh that belongs to the current mesh
-			c.baseVertex = eOpenGl->currentVertexOffset;
+			// first vertex of the geometry pool that belongs to the current mesh
+			c.baseVertex = m->vertexOffset;
 
 			// index of the mesh in the composed mesh
 			c.baseInstance = eOpenGl->instance;
 
 			// increase counters
 			eOpenGl->instance++;
-			eOpenGl->currentIndexOffset += m->indices.size();
-			eOpenGl->currentVertexOffset += m->vertices.size();
 
 			// add draw command to the list
 			eOpenGl->dICommands.push_back(c);
@@ -181,9 +171,8 @@ void ERasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpenGl* eOp
 		// bind main vertex array object (prior vao should be from the PostFx stage);
 		glBindVertexArray(eOpenGl->vao);
 
-		// resize vertex array object
+		// the geometry pool keeps its buffers, they only need to be bound
 		glBindBuffer(GL_ARRAY_BUFFER, eOpenGl->gVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, eOpenGl->vVertex.size() * sizeof(Vertex), &eOpenGl->vVertex[0], GL_STATIC_DRAW);
 
 
 		// copy vertex positions
@@ -197,19 +186,16 @@ void ERasterizer::BuildMeshes(bool assetsChanged, bool meshChanged, EOpenGl* eOp
 		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
 
 
-		// resize and copy element buffer
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eOpenGl->gElementBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, eOpenGl->gIndex.size() * sizeof(unsigned int), &eOpenGl->gIndex[0], GL_STATIC_DRAW);
 
 		// resize and copy draw command buffer
 		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, eOpenGl->gIndirectBuffer);
 		glBufferData(GL_DRAW_INDIRECT_BUFFER, eOpenGl->dICommands.size() * sizeof(DrawElementsIndirectCommand), &eOpenGl->dICommands[0], GL_STATIC_DRAW);
 
-		// resize and copy offset buffer
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->drawIdOffsetBuffer);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * eOpenGl->drawInstanceOffset.size(), eOpenGl->drawInstanceOffset.data(), GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, eOpenGl->drawIdOffsetBuffer);
+		// copy offset buffer
+		eOpenGl->drawIdOffsetBuffer.Write(eOpenGl->drawInstanceOffset.data(), sizeof(int) * eOpenGl->drawInstanceOffset.size(), 6);
 
+		culler.SetInstances(Game::meshs);
 	}
 }
 
@@ -235,22 +221,42 @@ void ERasterizer::BuildUI(EOpenGl * eOpenGl)
 		eOpenGl->ERUIElements.push_back(u);
 	}
 	// copy the atribute vector to the GPU
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, eOpenGl->uiElementsSSBO);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(ERendererUIElement) * eOpenGl->ERUIElements.size(), eOpenGl->ERUIElements.data(), GL_DYNAMIC_DRAW);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	eOpenGl->uiElementsSSBO.Write(eOpenGl->ERUIElements.data(), sizeof(ERendererUIElement) * eOpenGl->ERUIElements.size(), 7);
 
 }
 
 void ERasterizer::BuildDrawAtrib(EOpenGl * eOpenGl)
 {
-	if (assetChanged || assetCreated) {
+	// shadow casters outside the view still throw shadows into it
+	mat4 viewProjection = Game::Projection * Game::View;
+	vector<vec4> keepSpheres;
+	for each (Lamp* l in Game::lamps)
+	{
+		if (l->throwShadows) {
+			keepSpheres.push_back(vec4(l->parents[0]->position, shadowRange));
+		}
+	}
+
+	if (assetChanged || assetCreated || viewProjection != culledViewProjection || keepSpheres != culledKeepSpheres) {
+		culledViewProjection = viewProjection;
+		culledKeepSpheres = keepSpheres;
+		culler.Cull(viewProjection, Game::activeCam->position, maxDrawDistance, keepSpheres);
+
 		// create a vector for the draw Atributes
 		int i = 0;
 		vector<DrawMeshAtributes> drawAtrib;
-		for each (Mesh* m in Game::meshs) {
+		eOpenGl->drawInstanceOffset.clear();
+		eOpenGl->drawInstanceOffset.push_back(0);
+		for (unsigned int d = 0; d < Game::meshs.size(); d++) {
+			Mesh* m = Game::meshs[d];
 			int lastoffset = eOpenGl->drawInstanceOffset.back();
-		
-			for each(Asset* as in m->parents) {
+
+			// only the visible instances are drawn, the offsets are calculated like in BuildMeshes
+			int visibleCount = culler.visible[d].size();
+			eOpenGl->dICommands[d].primCount = visibleCount;
+			eOpenGl->drawInstanceOffset.push_back(lastoffset + ((visibleCount > 0) ? visibleCount - 1 : -1));
+
+			for each(Asset* as in culler.visible[d]) {
 				// create a new atribute
 				DrawMeshAtributes a = DrawMeshAtributes();
 
@@ -280,55 +286,56 @@ void ERasterizer::BuildDrawAtrib(EOpenGl * eOpenGl)
 			}
 		}
 
-		// copy the atribute vector to the GPU
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, eOpenGl->meshDataSSBO);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DrawMeshAtributes) * drawAtrib.size(), drawAtrib.data(), GL_DYNAMIC_DRAW);
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		// copy the atribute vector, the instance counts and the offsets to the GPU
+		eOpenGl->meshDataSSBO.Write(drawAtrib.data(), sizeof(DrawMeshAtributes) * drawAtrib.size(), 5);
+		if (!eOpenGl->dICommands.empty()) {
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, eOpenGl->gIndirectBuffer);
+			glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, eOpenGl->dICommands.size() * sizeof(DrawElementsIndirectCommand), eOpenGl->dICommands.data());
+		}
+		eOpenGl->drawIdOffsetBuffer.Write(eOpenGl->drawInstanceOffset.data(), sizeof(int) * eOpenGl->drawInstanceOffset.size(), 6);
 	}
 }
 
 void ERasterizer::RenderShadowMaps(EOpenGl * eOpenGl)
 {
+	// the array keeps its storage and the layers of the lamps that didn't change
+	shadowCache.AllocateCubeMaps(eOpenGl->shadowMaps, Lamp::SHADOW_WIDTH, Lamp::SHADOW_HEIGHT);
+	vector<Lamp*> casters;
+	for each (Lamp* l in Game::lamps)
+	{
+		if (l->throwShadows && !l->parents.empty()) {
+			casters.push_back(l);
+		}
+	}
+	shadowCache.Update(casters, shadowRange);
+	if (!shadowCache.AnyDirty) {
+		return;
+	}
+
 	// use the lightmap shader
 	Shader* shader = Mesh::lightmapShader;
 	shader->use();
 
-	// get the number of lights in a scene
-	int lightcount = Game::lamps.size();
-
-	// bind the cubemap array containing the shadowmap
-	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, eOpenGl->shadowMaps);
-
-	// setup the texture array to resize to fit all the lights in the scene
-	glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT32, Lamp::SHADOW_WIDTH, Lamp::SHADOW_HEIGHT, 6 * lightcount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LESS);
-
 	// change the viewport to the resolution of the shadowmaps
 	glViewport(0, 0, Lamp::SHADOW_WIDTH, Lamp::SHADOW_HEIGHT);
 
-	// bind the Texture array to framebuffer and clear it
+	// bind the Texture array to framebuffer
 	glBindFramebuffer(GL_FRAMEBUFFER, Lamp::depthMapFBO);
 	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, eOpenGl->shadowMaps, 0);
-	glClearDepth(1);
-	glClear(GL_DEPTH_BUFFER_BIT);
 
 	// render each lamp to a layer
 	int count = 0;
-	for each (Lamp* l in Game::lamps)
+	for each (Lamp* l in shadowCache.Casters)
 	{
-
-		// only rerender the layer if a shadowmap is needed
-		if (l->throwShadows) {
+		// only rerender the layer if the lamp or a caster in its range moved
+		if (l->shadowDirty) {
+			l->shadowDirty = false;
+			shadowCache.ClearLayer(eOpenGl->shadowMaps, count);
 
 			// create the projection matrix
 			float aspect = (float)Lamp::SHADOW_WIDTH / (float)Lamp::SHADOW_WIDTH;
 			float Snear = 1.0f;
-			float Sfar = 25.0f;
+			float Sfar = shadowRange;
 			glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), aspect, Snear, Sfar);
 			vec3 lightPos = l->parents[0]->position;
 			std::vector<glm::mat4> shadowTransforms;
@@ -351,12 +358,17 @@ void ERasterizer::RenderShadowMaps(EOpenGl * eOpenGl)
 			}
 			shader->setInt(eOpenGl->shadowUniformLayer, count);
 
+			// the cube array has six faces for every lamp, spot lamps included
+			if (eOpenGl->shadowUniformFaceCount < 0) {
+				eOpenGl->shadowUniformFaceCount = glGetUniformLocation(shader->ID, "faceCount");
+			}
+			shader->setInt(eOpenGl->shadowUniformFaceCount, 6);
+
 			// copy the created shadow matrix to the GPU
 			if (eOpenGl->shadowUniformShadowMatrices < 0) {
 				eOpenGl->shadowUniformShadowMatrices = glGetUniformLocation(shader->ID, "shadowMatrices");
 			}
 			glUniformMatrix4fv(eOpenGl->shadowUniformShadowMatrices, shadowTransforms.size(), GL_FALSE, glm::value_ptr(shadowTransforms[0]));
-			count++;
 
 
 			if (eOpenGl->shadowUniformFar_plane < 0) {
@@ -379,6 +391,7 @@ void ERasterizer::RenderShadowMaps(EOpenGl * eOpenGl)
 				eOpenGl->instance,
 				0);
 		}
+		count++;
 	}
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -386,6 +399,8 @@ void ERasterizer::RenderShadowMaps(EOpenGl * eOpenGl)
 void ERasterizer::SetupFrame(bool meshChanged, EOpenGl * eOpenGl)
 {
 	BuildMeshes(assetChanged || assetCreated, meshChanged, eOpenGl);
+	// changed vertices (soft bodies) are uploaded into their own ranges
+	eOpenGl->UpdateVertices(Game::meshs);
 	BuildDrawAtrib(eOpenGl);
 }
 
@@ -667,13 +682,15 @@ void ERasterizer::SetupLamps(EOpenGl * eOpenGl, Shader * shader)
 	// create vectors for light colors and positions
 	vector<vec4> lightColors;
 	vector<vec4> lightPositions;
+	vector<vec4> lightDirections;
 
-	// add color and position for each light to vectors
+	// add color, position and cone for each light to vectors
 	for each (Lamp* l in Game::lamps) {
 		vec3 outcol = l->color;
 		vec3 outpos = l->parents[0]->position;
 		lightColors.push_back(vec4(outcol, 0));
-		lightPositions.push_back(vec4(outpos, 0));
+		lightPositions.push_back(vec4(outpos, l->radius));
+		lightDirections.push_back(l->getCone());
 	}
 
 	// dont do this for the ssr shader
@@ -689,16 +706,13 @@ void ERasterizer::SetupLamps(EOpenGl * eOpenGl, Shader * shader)
 
 
 	// copy color SSBO
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->lightColorSSBO);
-	GLsizeiptr lcs = sizeof(glm::vec4) * (lightColors.size());
-	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 3, eOpenGl->lightColorSSBO, 0, lcs);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, lcs, lightColors.data(), GL_DYNAMIC_DRAW);
+	eOpenGl->lightColorSSBO.Write(lightColors.data(), sizeof(glm::vec4) * lightColors.size(), 3);
 
 	// copy position SSBO
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, eOpenGl->lightPositionSSBO);
-	GLsizeiptr lps = sizeof(glm::vec4) * lightPositions.size();
-	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, eOpenGl->lightPositionSSBO, 0, lps);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, lps, lightPositions.data(), GL_DYNAMIC_DRAW);
+	eOpenGl->lightPositionSSBO.Write(lightPositions.data(), sizeof(glm::vec4) * lightPositions.size(), 4);
+
+	// copy cone SSBO
+	eOpenGl->lightDirectionSSBO.Write(lightDirections.data(), sizeof(glm::vec4) * lightDirections.size(), 19);
 }
 
 void ERasterizer::RenderUI(EOpenGl * eOpenGl, EDisplaySettings * displaySettings)
@@ -1,6 +1,8 @@
 #pragma once
 #include <ERender.h>
 #include <Game.h>
+#include <ECpuCuller.h>
+#include <EShadowCache.h>
 
 class ERasterizer: public ERenderer
 {
@@ -23,10 +25,20 @@ public:
 
 	const unsigned int TextureSize = 1024;
 	const unsigned int TextureCount = 64;
+
+	// instances further away from the camera are not drawn
+	float maxDrawDistance = 100.0f;
+	// far plane of the shadow maps, instances this close to a shadow throwing lamp are drawn even outside the view
+	float shadowRange = 25.0f;
 private:
+	ECpuCuller culler;
+	// what the draw atributes were last culled with
+	mat4 culledViewProjection;
+	vector<vec4> culledKeepSpheres;
+	EShadowCache shadowCache;
 
 	///<summary>
-	///builds the composed mesh needed for multiDrawIndirect and copies it to the GPU buffers
+	///adds new meshes to the geometry pool and builds the draw commands needed for multiDrawIndirect
 	///</summary> 
 	///<param name="assetsChanged">
 	///indicates if the assets changed last frame (NOT their atributes)
@@ -43,7 +55,8 @@ private:
 	void BuildUI(EOpenGl* eOpenG);
 
 	///<summary>
-	///builds the list of draw atributes and copies it to the GPU buffers
+	///culls the instances and builds the list of draw atributes of the visible ones, sets the instance counts of the draw commands
+	///and copies both to the GPU buffers
 	///</summary> 
 	///<param name="eOpenGl">
 	///the EOpenGl object that holds the buffers ids that should be worked on
@@ -86,41 +86,44 @@ void ERaytracer::RenderFrame(EOpenGl * eOpenGl, EDisplaySettings * displaySettin
 	glClear(GL_DEPTH_BUFFER_BIT);
 		
 	vector<RaytracerTriangle> tirangles;
-	
+
+	// the raytracer only shoots primary rays, so instances outside the view are not packed
+	culler.SetInstances(Game::meshs);
+	culler.Cull(Projection * View, Game::activeCam->position, maxDrawDistance, vector<vec4>());
+
 	int assetNum = 0;
-	for each (Asset* a in Game::assets)
+	for (unsigned int d = 0; d < Game::meshs.size(); d++)
 	{
-		for each (AssetComponent* c in a->components)
+		Mesh* m = Game::meshs[d];
+		for each (Asset* a in culler.visible[d])
 		{
-			if (Mesh* m = static_cast<Mesh*>(c)) {
-				mat4 model = mat4(1.0f);
-				model = translate(model, a->position + m->posOffset);
-				model = glm::scale(model, a->scale + m->scaleOffset);
-
-				mat4 Rot = glm::toMat4(a->q);
-
-				for (int i = 0; i < m->indices.size() / 3; i++) {
-					RaytracerTriangle tri = RaytracerTriangle();
-					vec4 p0 = vec4(m->vertices[m->indices[i * 3    ]].Position, 1);
-					vec4 p1 = vec4(m->vertices[m->indices[i * 3 + 1]].Position, 1);
-					vec4 p2 = vec4(m->vertices[m->indices[i * 3 + 2]].Position, 1);
-					/*		
-					tri.p0T = vec3(model * vec4(m->vertices[m->indices[i * 3    ]].TexCoords, 1, 1));
-					tri.p1T = vec3(model * vec4(m->vertices[m->indices[i * 3 + 1]].TexCoords, 1, 1));
-					tri.p2T = vec3(model * vec4(m->vertices[m->indices[i * 3 + 2]].TexCoords, 1, 1));
-					*/
-					tri.p0 = model * p0;
-					tri.p1 = model * p1;
-					tri.p2 = model * p2;
-
-					vec3 v1 = (tri.p0 - tri.p2);
-					vec3 v2 = (tri.p0 - tri.p1);
-					tri.normal = vec4(normalize(cross(v1,v2)),1);
-					tri.drawData = assetNum;
-					tirangles.push_back(tri);
-				}
-				assetNum++;
+			mat4 model = mat4(1.0f);
+			model = translate(model, a->position + m->posOffset);
+			model = glm::scale(model, a->scale + m->scaleOffset);
+
+			mat4 Rot = glm::toMat4(a->q);
+
+			for (int i = 0; i < m->indices.size() / 3; i++) {
+				RaytracerTriangle tri = RaytracerTriangle();
+				vec4 p0 = vec4(m->vertices[m->indices[i * 3    ]].Position, 1);
+				vec4 p1 = vec4(m->vertices[m->indices[i * 3 + 1]].Position, 1);
+				vec4 p2 = vec4(m->vertices[m->indices[i * 3 + 2]].Position, 1);
+				/*		
+				tri.p0T = vec3(model * vec4(m->vertices[m->indices[i * 3    ]].TexCoords, 1, 1));
+				tri.p1T = vec3(model * vec4(m->vertices[m->indices[i * 3 + 1]].TexCoords, 1, 1));
+				tri.p2T = vec3(model * vec4(m->vertices[m->indices[i * 3 + 2]].TexCoords, 1, 1));
+				*/
+				tri.p0 = model * p0;
+				tri.p1 = model * p1;
+				tri.p2 = model * p2;
+
+				vec3 v1 = (tri.p0 - tri.p2);
+				vec3 v2 = (tri.p0 - tri.p1);
+				tri.normal = vec4(normalize(cross(v1,v2)),1);
+				tri.drawData = assetNum;
+				tirangles.push_back(tri);
 			}
+			assetNum++;
 		}
 	}
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "ERender.h"
+#include <ECpuCuller.h>
 class ERaytracer :
 	public ERenderer
 {
@@ -22,6 +23,10 @@ private:
 	GLuint eyeUniform = -1;
 	GLuint triangleBuffer;
 
+	// only the triangles of the instances in the view are packed
+	ECpuCuller culler;
+	float maxDrawDistance = 100.0f;
+
 	Shader* rayComputeShader;
 	Shader* rayDisplayShader;
 
@@ -0,0 +1,181 @@
+#include "EReflectionPass.h"
+#include <Game.h>
+
+EReflectionPass::EReflectionPass(EHiZPass* hiZ, GLuint positionBuffer, GLuint normalBuffer, GLuint albedoSpecBuffer, GLuint materialBuffer, GLuint colorBuffer)
+{
+	this->hiZ = hiZ;
+	PositionBuffer = positionBuffer;
+	NormalBuffer = normalBuffer;
+	AlbedoSpecBuffer = albedoSpecBuffer;
+	MaterialBuffer = materialBuffer;
+	ColorBuffer = colorBuffer;
+}
+
+
+EReflectionPass::~EReflectionPass()
+{
+}
+
+void EReflectionPass::Render()
+{
+	int scaledWidth = (std::max)(1, (int)(displaySettings->windowWidth * ResolutionScale));
+	int scaledHeight = (std::max)(1, (int)(displaySettings->windowHeight * ResolutionScale));
+	if (scaledWidth != width || scaledHeight != height) {
+		width = scaledWidth;
+		height = scaledHeight;
+		allocate();
+	}
+	int tilesX = (width + tileSize - 1) / tileSize;
+	int tilesY = (height + tileSize - 1) / tileSize;
+
+	ERenderPass::Render();
+	uniformFrameIndex.Update(frameIndex);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, PositionBuffer);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, NormalBuffer);
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, MaterialBuffer);
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_2D, ColorBuffer);
+	glActiveTexture(GL_TEXTURE0 + EHiZPass::textureUnit);
+	glBindTexture(GL_TEXTURE_2D, hiZ->Pyramid);
+
+	// pixels that aren't traced have no reflection
+	float none[4] = { 0, 0, 0, 0 };
+	glClearTexImage(current, 0, GL_RGBA, GL_FLOAT, none);
+	glBindImageTexture(0, current, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+	// collect the tiles with reflective pixels, they are the groups of the indirect dispatch of the trace
+	GLuint dispatch[3] = { 0, 1, 1 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(dispatch), dispatch);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, tileBinding, tileBuffer);
+	uniformStage.Update(0);
+	glDispatchCompute(tilesX, tilesY, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	uniformStage.Update(1);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, tileBuffer);
+	glDispatchComputeIndirect(0);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	// accumulate with the history of the last frames
+	int nextHistory = 1 - historyIndex;
+	resolveShader->use();
+	uniformResolveInvProj.Update(inverse(Game::Projection));
+	uniformResolveInvView.Update(inverse(Game::View));
+	uniformResolveProj.Update(Game::Projection);
+	uniformResolvePreviousView.Update(previousView);
+	uniformResolveHistoryValid.Update(historyValid);
+	uniformResolveBlend.Update(HistoryBlend);
+	glBindFramebuffer(GL_FRAMEBUFFER, renderBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history[nextHistory], 0);
+	glViewport(0, 0, width, height);
+	glDisable(GL_DEPTH_TEST);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, current);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, history[historyIndex]);
+	Game::eOpenGl->renderQuad();
+
+	// add the upsampled reflections to the lit frame
+	upsampleShader->use();
+	uniformUpsampleViewPos.Update(Game::activeCam->position);
+	uniformUpsampleMaxRoughness.Update(MaxRoughness);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ColorBuffer, 0);
+	glViewport(0, 0, displaySettings->windowWidth, displaySettings->windowHeight);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, PositionBuffer);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, NormalBuffer);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, AlbedoSpecBuffer);
+	glActiveTexture(GL_TEXTURE4);
+	glBindTexture(GL_TEXTURE_2D, history[nextHistory]);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	Game::eOpenGl->renderQuad();
+	glDisable(GL_BLEND);
+	glActiveTexture(GL_TEXTURE0);
+
+	historyIndex = nextHistory;
+	historyValid = true;
+	previousView = Game::View;
+	frameIndex++;
+}
+
+void EReflectionPass::Initialize()
+{
+	_shader = new Shader("..\\shaders\\SSRTrace.comp");
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "gPosition", 0));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "gNormal", 1));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "gMaterial", 3));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "gColor", 5));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "hiZ", EHiZPass::textureUnit));
+	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "view", []() {return Game::View; }));
+	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "proj", []() {return Game::Projection; }));
+	_uniforms.push_back(new EOGLUniform<float>(_shader, "maxRoughness", MaxRoughness));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "maxSteps", MaxSteps));
+	uniformStage = EOGLUniform<int>(_shader, "stage", 0);
+	uniformFrameIndex = EOGLUniform<int>(_shader, "frameIndex", 0);
+
+	resolveShader = new Shader("..\\shaders\\geometry.vert", "..\\shaders\\SSRResolve.frag");
+	resolveShader->use();
+	resolveShader->setInt("current", 0);
+	resolveShader->setInt("history", 1);
+	resolveShader->setInt("hiZ", EHiZPass::textureUnit);
+	uniformResolveInvProj = EOGLUniform<mat4>(resolveShader, "invProj", mat4(1));
+	uniformResolveInvView = EOGLUniform<mat4>(resolveShader, "invView", mat4(1));
+	uniformResolveProj = EOGLUniform<mat4>(resolveShader, "proj", mat4(1));
+	uniformResolvePreviousView = EOGLUniform<mat4>(resolveShader, "previousView", mat4(1));
+	uniformResolveHistoryValid = EOGLUniform<bool>(resolveShader, "historyValid", false);
+	uniformResolveBlend = EOGLUniform<float>(resolveShader, "blend", HistoryBlend);
+
+	upsampleShader = new Shader("..\\shaders\\geometry.vert", "..\\shaders\\SSRUpsample.frag");
+	upsampleShader->use();
+	upsampleShader->setInt("gPosition", 0);
+	upsampleShader->setInt("gNormal", 1);
+	upsampleShader->setInt("gAlbedoSpec", 2);
+	upsampleShader->setInt("gMaterial", 3);
+	upsampleShader->setInt("reflections", 4);
+	upsampleShader->setInt("hiZ", EHiZPass::textureUnit);
+	uniformUpsampleViewPos = EOGLUniform<vec3>(upsampleShader, "viewPos", vec3(0));
+	uniformUpsampleMaxRoughness = EOGLUniform<float>(upsampleShader, "maxRoughness", MaxRoughness);
+
+	glGenBuffers(1, &tileBuffer);
+	ERenderPass::Initialize();
+}
+
+void EReflectionPass::allocate()
+{
+	glDeleteTextures(1, &current);
+	glDeleteTextures(2, history);
+	current = createTexture();
+	history[0] = createTexture();
+	history[1] = createTexture();
+	historyValid = false;
+
+	// the dispatch arguments and one entry for every tile
+	int tileCount = ((width + tileSize - 1) / tileSize) * ((height + tileSize - 1) / tileSize);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, (3 + tileCount) * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+GLuint EReflectionPass::createTexture()
+{
+	// rgb = reflected color, a = confidence of the hit
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "ERenderPass.h"
+#include <EHiZPass.h>
+
+///<summary>
+///screen space reflections at a reduced resolution. A first dispatch finds the 8x8 tiles that have pixels smooth enough to reflect, only those
+///are traced, with an indirect dispatch. The rays walk the closest depth pyramid of the frame, skipping cells they are in front of, rough surfaces
+///get less steps and tilted rays that the temporal filter averages. The result is upsampled along the depth edges and added to the lit frame
+///</summary>
+class EReflectionPass :
+	public ERenderPass
+{
+public:
+	EReflectionPass(EHiZPass* hiZ, GLuint positionBuffer, GLuint normalBuffer, GLuint albedoSpecBuffer, GLuint materialBuffer, GLuint colorBuffer);
+	~EReflectionPass();
+
+	virtual void Render();
+	virtual void Initialize();
+
+	GLuint PositionBuffer;
+	GLuint NormalBuffer;
+	GLuint AlbedoSpecBuffer;
+	GLuint MaterialBuffer;
+	// the output of the illumination pass, the rays read their color from it and the reflections are added to it
+	GLuint ColorBuffer;
+	// size of the pass relative to the window
+	float ResolutionScale = 0.5f;
+	// surfaces rougher than this get no reflections
+	float MaxRoughness = 0.6f;
+	// steps through the pyramid of a mirror
+	int MaxSteps = 48;
+	// the part of a new frame in the accumulated reflections
+	float HistoryBlend = 0.2f;
+
+	// binding point of the indirect dispatch and the reflective tiles
+	static const int tileBinding = 24;
+	static const int tileSize = 8;
+
+private:
+	// (re)creates the textures and the tile buffer at the scaled window size, the history is invalid after that
+	void allocate();
+	GLuint createTexture();
+
+	EHiZPass* hiZ;
+	Shader* resolveShader;
+	Shader* upsampleShader;
+	EOGLUniform<int> uniformStage;
+	EOGLUniform<int> uniformFrameIndex;
+	EOGLUniform<mat4> uniformResolveInvProj;
+	EOGLUniform<mat4> uniformResolveInvView;
+	EOGLUniform<mat4> uniformResolveProj;
+	EOGLUniform<mat4> uniformResolvePreviousView;
+	EOGLUniform<bool> uniformResolveHistoryValid;
+	EOGLUniform<float> uniformResolveBlend;
+	EOGLUniform<vec3> uniformUpsampleViewPos;
+	EOGLUniform<float> uniformUpsampleMaxRoughness;
+
+	// the reflections traced this frame and two histories, one is read while the other is written
+	GLuint current = 0;
+	GLuint history[2] = { 0, 0 };
+	int historyIndex = 0;
+	bool historyValid = false;
+	GLuint tileBuffer = 0;
+	int width = 0;
+	int height = 0;
+	int frameIndex = 0;
+	mat4 previousView;
+};
@@ -61,6 +61,52 @@ void EScriptContext::RunFunction(const char * name)
 	JsCallFunction(func, args, 1, &result);
 }
 
+void EScriptContext::RunCollisionHandler(const vector<ECollisionEvent>& events)
+{
+	JsValueRef func, funcPropId, global, undefined, result, jsEvents;
+	JsGetGlobalObject(&global);
+	JsCreatePropertyId("OnCollision", strlen("OnCollision"), &funcPropId);
+	JsGetProperty(global, funcPropId, &func);
+	// the script does not handle collisions
+	JsValueType funcType;
+	if (JsGetValueType(func, &funcType) != JsNoError || funcType != JsFunction)
+		return;
+
+	JsCreateArray((unsigned int)events.size(), &jsEvents);
+	for (unsigned int i = 0; i < events.size(); i++)
+	{
+		JsValueRef index, jsEvent;
+		JsIntToNumber(i, &index);
+		JsCreateExternalObject(new ECollisionEvent(events[i]), EJSFunction::JSFinalizeCollisionEvent, &jsEvent);
+		JsSetPrototype(jsEvent, EJSFunction::JSCollisionEventPrototype);
+		JsSetIndexedProperty(jsEvents, index, jsEvent);
+	}
+
+	JsGetUndefinedValue(&undefined);
+	JsValueRef args[] = { undefined, jsEvents };
+	JsCallFunction(func, args, 2, &result);
+}
+
+void EScriptContext::RunTriggerHandler(const char * name, ETriggerVolume * trigger, Asset * asset)
+{
+	JsValueRef func, funcPropId, global, undefined, result, jsTrigger, jsAsset;
+	JsGetGlobalObject(&global);
+	JsCreatePropertyId(name, strlen(name), &funcPropId);
+	JsGetProperty(global, funcPropId, &func);
+	JsValueType funcType;
+	if (JsGetValueType(func, &funcType) != JsNoError || funcType != JsFunction)
+		return;
+
+	JsCreateExternalObject(trigger, nullptr, &jsTrigger);
+	JsSetPrototype(jsTrigger, EJSFunction::JSTriggerVolumePrototype);
+	JsCreateExternalObject(asset, nullptr, &jsAsset);
+	JsSetPrototype(jsAsset, EJSFunction::JSAssetPrototype);
+
+	JsGetUndefinedValue(&undefined);
+	JsValueRef args[] = { undefined, jsTrigger, jsAsset };
+	JsCallFunction(func, args, 3, &result);
+}
+
 void EScriptContext::ReadScript(wstring filename)
 {
 	FILE *file;
@@ -181,7 +227,12 @@ void EScriptContext::AddBindings()
 	UIElementBindings();
 	AssetBindings();
 	RayCastBindings();
+	TriggerVolumeBindings();
+	PhysicsSnapshotBindings();
+	SoftBodyBindings();
+	LampBindings();
 	CameraBindings();
+	CollisionEventBindings();
 
 	// Setup bindings for global functions 
 	GlobalConsoleBindings();
@@ -377,6 +428,19 @@ void EScriptContext::AssetBindings()
 	memberNamesAsset.push_back(L"equals");
 	memberFuncsAsset.push_back(EJSFunction::JSAssetEqual);
 
+	memberNamesAsset.push_back(L"setCollisionEvents");
+	memberFuncsAsset.push_back(EJSFunction::JSAssetSetCollisionEvents);
+
+	memberNamesAsset.push_back(L"setCollisionLayer");
+	memberFuncsAsset.push_back(EJSFunction::JSAssetSetCollisionLayer);
+	memberNamesAsset.push_back(L"getCollisionLayer");
+	memberFuncsAsset.push_back(EJSFunction::JSAssetGetCollisionLayer);
+
+	memberNamesAsset.push_back(L"setCcd");
+	memberFuncsAsset.push_back(EJSFunction::JSAssetSetCcd);
+	memberNamesAsset.push_back(L"setCcdEnabled");
+	memberFuncsAsset.push_back(EJSFunction::JSAssetSetCcdEnabled);
+
 	projectNativeClass(L"Asset", EJSFunction::JSConstructorAsset, EJSFunction::JSAssetPrototype, memberNamesAsset, memberFuncsAsset);
 }
 
@@ -415,6 +479,102 @@ void EScriptContext::CameraBindings()
 	projectNativeClass(L"Camera", EJSFunction::JSConstructorCamera, EJSFunction::JSCameraPrototype , memberNamesCamera, memberFuncsCamera);
 }
 
+void EScriptContext::CollisionEventBindings()
+{
+	vector<const wchar_t *> memberNamesCollision;
+	vector<JsNativeFunction> memberFuncsCollision;
+
+	memberNamesCollision.push_back(L"getType");
+	memberFuncsCollision.push_back(EJSFunction::JSCollisionEventGetType);
+
+	memberNamesCollision.push_back(L"getAssetA");
+	memberFuncsCollision.push_back(EJSFunction::JSCollisionEventGetAssetA);
+	memberNamesCollision.push_back(L"getAssetB");
+	memberFuncsCollision.push_back(EJSFunction::JSCollisionEventGetAssetB);
+
+	memberNamesCollision.push_back(L"getPoint");
+	memberFuncsCollision.push_back(EJSFunction::JSCollisionEventGetPoint);
+	memberNamesCollision.push_back(L"getNormal");
+	memberFuncsCollision.push_back(EJSFunction::JSCollisionEventGetNormal);
+	memberNamesCollision.push_back(L"getImpulse");
+	memberFuncsCollision.push_back(EJSFunction::JSCollisionEventGetImpulse);
+
+	projectNativeClass(L"CollisionEvent", EJSFunction::JSConstructorCollisionEvent, EJSFunction::JSCollisionEventPrototype, memberNamesCollision, memberFuncsCollision);
+}
+
+void EScriptContext::TriggerVolumeBindings()
+{
+	vector<const wchar_t *> memberNamesTrigger;
+	vector<JsNativeFunction> memberFuncsTrigger;
+
+	memberNamesTrigger.push_back(L"getPosition");
+	memberFuncsTrigger.push_back(EJSFunction::JSTriggerVolumeGetPosition);
+	memberNamesTrigger.push_back(L"setPosition");
+	memberFuncsTrigger.push_back(EJSFunction::JSTriggerVolumeSetPosition);
+
+	memberNamesTrigger.push_back(L"getOverlapping");
+	memberFuncsTrigger.push_back(EJSFunction::JSTriggerVolumeGetOverlapping);
+
+	memberNamesTrigger.push_back(L"destroy");
+	memberFuncsTrigger.push_back(EJSFunction::JSTriggerVolumeDelete);
+
+	memberNamesTrigger.push_back(L"equals");
+	memberFuncsTrigger.push_back(EJSFunction::JSTriggerVolumeEqual);
+
+	projectNativeClass(L"TriggerVolume", EJSFunction::JSConstructorTriggerVolume, EJSFunction::JSTriggerVolumePrototype, memberNamesTrigger, memberFuncsTrigger);
+}
+
+void EScriptContext::PhysicsSnapshotBindings()
+{
+	vector<const wchar_t *> memberNamesSnapshot;
+	vector<JsNativeFunction> memberFuncsSnapshot;
+
+	memberNamesSnapshot.push_back(L"restore");
+	memberFuncsSnapshot.push_back(EJSFunction::JSPhysicsSnapshotRestore);
+
+	projectNativeClass(L"PhysicsSnapshot", EJSFunction::JSConstructorPhysicsSnapshot, EJSFunction::JSPhysicsSnapshotPrototype, memberNamesSnapshot, memberFuncsSnapshot);
+}
+
+void EScriptContext::SoftBodyBindings()
+{
+	vector<const wchar_t *> memberNamesSoftBody;
+	vector<JsNativeFunction> memberFuncsSoftBody;
+
+	memberNamesSoftBody.push_back(L"pin");
+	memberFuncsSoftBody.push_back(EJSFunction::JSSoftBodyPin);
+	memberNamesSoftBody.push_back(L"anchor");
+	memberFuncsSoftBody.push_back(EJSFunction::JSSoftBodyAnchor);
+	memberNamesSoftBody.push_back(L"addForce");
+	memberFuncsSoftBody.push_back(EJSFunction::JSSoftBodyAddForce);
+	memberNamesSoftBody.push_back(L"destroy");
+	memberFuncsSoftBody.push_back(EJSFunction::JSSoftBodyDelete);
+
+	projectNativeClass(L"SoftBody", EJSFunction::JSConstructorSoftBody, EJSFunction::JSSoftBodyPrototype, memberNamesSoftBody, memberFuncsSoftBody);
+}
+
+void EScriptContext::LampBindings()
+{
+	vector<const wchar_t *> memberNamesLamp;
+	vector<JsNativeFunction> memberFuncsLamp;
+
+	memberNamesLamp.push_back(L"setType");
+	memberFuncsLamp.push_back(EJSFunction::JSLampSetType);
+	memberNamesLamp.push_back(L"getType");
+	memberFuncsLamp.push_back(EJSFunction::JSLampGetType);
+	memberNamesLamp.push_back(L"setSpotAngle");
+	memberFuncsLamp.push_back(EJSFunction::JSLampSetSpotAngle);
+	memberNamesLamp.push_back(L"getSpotAngle");
+	memberFuncsLamp.push_back(EJSFunction::JSLampGetSpotAngle);
+	memberNamesLamp.push_back(L"setRadius");
+	memberFuncsLamp.push_back(EJSFunction::JSLampSetRadius);
+	memberNamesLamp.push_back(L"getRadius");
+	memberFuncsLamp.push_back(EJSFunction::JSLampGetRadius);
+	memberNamesLamp.push_back(L"setDirection");
+	memberFuncsLamp.push_back(EJSFunction::JSLampSetDirection);
+
+	projectNativeClass(L"Lamp", EJSFunction::JSConstructorLamp, EJSFunction::JSLampPrototype, memberNamesLamp, memberFuncsLamp);
+}
+
 void EScriptContext::GlobalConsoleBindings()
 {
 	vector<const wchar_t *> memberNames;
@@ -443,5 +603,29 @@ void EScriptContext::GloablGameBindings()
 	memberFuncs.push_back(EJSFunction::JSRaycast);
 	memberNames.push_back(L"getActiveCamera");
 	memberFuncs.push_back(EJSFunction::JSGetActiveCam);
+	memberNames.push_back(L"getLayerMask");
+	memberFuncs.push_back(EJSFunction::JSGetLayerMask);
+	memberNames.push_back(L"setLayersCollide");
+	memberFuncs.push_back(EJSFunction::JSSetLayersCollide);
+	memberNames.push_back(L"overlapSphere");
+	memberFuncs.push_back(EJSFunction::JSOverlapSphere);
+	memberNames.push_back(L"overlapBox");
+	memberFuncs.push_back(EJSFunction::JSOverlapBox);
+	memberNames.push_back(L"overlapSpheres");
+	memberFuncs.push_back(EJSFunction::JSOverlapSpheres);
+	memberNames.push_back(L"sweepSphere");
+	memberFuncs.push_back(EJSFunction::JSSweepSphere);
+	memberNames.push_back(L"sweepBox");
+	memberFuncs.push_back(EJSFunction::JSSweepBox);
+	memberNames.push_back(L"capturePhysics");
+	memberFuncs.push_back(EJSFunction::JSCapturePhysics);
+	memberNames.push_back(L"setFixedTimestep");
+	memberFuncs.push_back(EJSFunction::JSSetFixedTimestep);
+	memberNames.push_back(L"verifyPhysicsReplay");
+	memberFuncs.push_back(EJSFunction::JSVerifyPhysicsReplay);
+	memberNames.push_back(L"setCcdSpeedThreshold");
+	memberFuncs.push_back(EJSFunction::JSSetCcdSpeedThreshold);
+	memberNames.push_back(L"bakePhysics");
+	memberFuncs.push_back(EJSFunction::JSBakePhysics);
 	projectNativeClassGlobal(L"game", memberNames, memberFuncs);
 }
@@ -31,6 +31,16 @@ public:
 	///</param>
 	void RunFunction(const char* name);
 
+	///<summary>
+	/// call the script function OnCollision(events) once with all events of the frame, if the script defines it
+	///</summary> 
+	void RunCollisionHandler(const vector<ECollisionEvent>& events);
+
+	///<summary>
+	/// call the script function name(trigger, asset), if the script defines it
+	///</summary> 
+	void RunTriggerHandler(const char* name, ETriggerVolume* trigger, Asset* asset);
+
 	void ReadScript(wstring filename);
 
 	static void projectNativeClass(const wchar_t *className, JsNativeFunction constructor, JsValueRef &prototype, vector<const wchar_t *> memberNames, vector<JsNativeFunction> memberFuncs);
@@ -60,6 +70,11 @@ private:
 	void AssetBindings();
 	void RayCastBindings();
 	void CameraBindings();
+	void CollisionEventBindings();
+	void TriggerVolumeBindings();
+	void PhysicsSnapshotBindings();
+	void SoftBodyBindings();
+	void LampBindings();
 
 	// setup global functions
 	void GlobalConsoleBindings();
@@ -0,0 +1,279 @@
+#include "EShadowAtlas.h"
+#include <Game.h>
+#include <algorithm>
+
+const int EShadowAtlas::tierSizes[EShadowAtlas::tierCount] = { 1024, 512, 256, 128 };
+const float EShadowAtlas::tierCoverage[EShadowAtlas::tierCount] = { 1.0f, 0.5f, 0.25f, 0.0f };
+
+void EShadowAtlas::Initialize(unsigned int size, int sunCascades)
+{
+	Size = size;
+	glGenTextures(1, &Texture);
+	glBindTexture(GL_TEXTURE_2D, Texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32, Size, Size);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LESS);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	float farDepth = 1.0f;
+	glClearTexImage(Texture, 0, GL_DEPTH_COMPONENT, GL_FLOAT, &farDepth);
+
+	// the atlas starts as a grid of free tiles of the largest size
+	for (unsigned int y = 0; y + tierSizes[0] <= Size; y += tierSizes[0])
+	{
+		for (unsigned int x = 0; x + tierSizes[0] <= Size; x += tierSizes[0])
+		{
+			freeTiles[0].push_back(ivec2(x, y));
+		}
+	}
+
+	// the sun is always in view, its tiles are never given back
+	for (int i = 0; i < sunCascades; i++)
+	{
+		ivec2 tile;
+		if (allocate(0, tile)) {
+			SunTiles.push_back(tile);
+		}
+	}
+}
+
+void EShadowAtlas::Update(const vector<Lamp*>& lamps, float range, const mat4& view, const mat4& projection)
+{
+	// the frustum planes, a lamp whose range is outside one of them can't light anything on screen
+	mat4 viewProjection = projection * view;
+	vec4 planes[6];
+	for (int i = 0; i < 6; i++)
+	{
+		int row = i / 2;
+		float side = (i % 2 == 0) ? 1.0f : -1.0f;
+		for (int c = 0; c < 4; c++)
+		{
+			planes[i][c] = viewProjection[c][3] + side * viewProjection[c][row];
+		}
+		planes[i] /= length(vec3(planes[i]));
+	}
+	vec3 eye = vec3(inverse(view)[3]);
+
+	// the tiles of removed lamps are free again
+	bool freed = false;
+	for (auto it = allocations.begin(); it != allocations.end();)
+	{
+		if (find(lamps.begin(), lamps.end(), it->first) == lamps.end()) {
+			releaseLamp(it->second);
+			freed = true;
+			it = allocations.erase(it);
+		}
+		else {
+			it++;
+		}
+	}
+
+	// the part of the screen height the range of every lamp covers, negative if it has no visible influence
+	vector<pair<float, Lamp*>> requests;
+	for each (Lamp* l in lamps)
+	{
+		Allocation& allocation = allocations[l];
+		float coverage = -1;
+		if (l->throwShadows && !l->parents.empty()) {
+			vec3 lightPos = l->parents[0]->position;
+			bool inside = true;
+			for (int p = 0; p < 6; p++)
+			{
+				inside &= dot(vec3(planes[p]), lightPos) + planes[p].w >= -range;
+			}
+			if (inside) {
+				float d = distance(eye, lightPos);
+				coverage = d <= range ? tierCoverage[0] : range * projection[1][1] / d;
+			}
+		}
+		int wanted = coverage < 0 ? -1 : tierFor(coverage, allocation.wanted);
+		int faces = l->type == spotLamp ? 1 : 6;
+
+		// lamps keep their tiles while they want the same size
+		if (wanted != allocation.wanted || faces != allocation.faces) {
+			if (allocation.tier >= 0) {
+				releaseLamp(allocation);
+				freed = true;
+			}
+			allocation.wanted = wanted;
+			allocation.faces = faces;
+		}
+		if (wanted >= 0 && allocation.tier < 0) {
+			requests.push_back(make_pair(coverage, l));
+		}
+	}
+
+	// lamps that only got smaller tiles than they wanted try again when tiles were freed
+	if (freed) {
+		for each (Lamp* l in lamps)
+		{
+			Allocation& allocation = allocations[l];
+			if (allocation.tier > allocation.wanted) {
+				releaseLamp(allocation);
+				requests.push_back(make_pair(tierCoverage[allocation.wanted], l));
+			}
+		}
+	}
+
+	// the lamps that cover most of the screen are packed first, if the atlas is full the others get smaller tiles or none
+	sort(requests.begin(), requests.end(), [](const pair<float, Lamp*>& a, const pair<float, Lamp*>& b) { return a.first > b.first; });
+	for each (pair<float, Lamp*> request in requests)
+	{
+		Allocation& allocation = allocations[request.second];
+		for (int tier = allocation.wanted; tier < tierCount && allocation.tier < 0; tier++)
+		{
+			int face = 0;
+			while (face < allocation.faces && allocate(tier, allocation.tiles[face]))
+			{
+				face++;
+			}
+			if (face == allocation.faces) {
+				allocation.tier = tier;
+			}
+			else {
+				for (int i = 0; i < face; i++)
+				{
+					release(tier, allocation.tiles[i]);
+				}
+			}
+		}
+		// new tiles have to be rendered
+		request.second->shadowDirty = true;
+	}
+
+	// the tiles of every lamp in texture coordinates, in the order of the lamps
+	Casters.clear();
+	vector<vec4> tiles;
+	for each (Lamp* l in lamps)
+	{
+		Allocation& allocation = allocations[l];
+		for (int face = 0; face < 6; face++)
+		{
+			if (allocation.tier < 0 || face >= allocation.faces) {
+				tiles.push_back(vec4(0));
+			}
+			else {
+				tiles.push_back(vec4(vec2(allocation.tiles[face]), tierSizes[allocation.tier], 0) / (float)Size);
+			}
+		}
+		if (allocation.tier >= 0) {
+			Casters.push_back(l);
+		}
+	}
+	tileSSBO.Write(tiles.data(), sizeof(vec4) * tiles.size(), tileBinding);
+}
+
+void EShadowAtlas::SetViewports(Lamp * lamp)
+{
+	Allocation& allocation = allocations[lamp];
+	setViewports(allocation.tiles, allocation.faces, tierSizes[allocation.tier]);
+}
+
+void EShadowAtlas::ClearTiles(Lamp * lamp)
+{
+	Allocation& allocation = allocations[lamp];
+	clearTiles(allocation.tiles, allocation.faces, tierSizes[allocation.tier]);
+}
+
+void EShadowAtlas::BeginSun()
+{
+	setViewports(SunTiles.data(), (int)SunTiles.size(), tierSizes[0]);
+	clearTiles(SunTiles.data(), (int)SunTiles.size(), tierSizes[0]);
+}
+
+void EShadowAtlas::setViewports(const ivec2 * tiles, int count, int size)
+{
+	for (int face = 0; face < count; face++)
+	{
+		glViewportIndexedf(face, (float)tiles[face].x, (float)tiles[face].y, (float)size, (float)size);
+	}
+}
+
+void EShadowAtlas::clearTiles(const ivec2 * tiles, int count, int size)
+{
+	float farDepth = 1.0f;
+	for (int face = 0; face < count; face++)
+	{
+		glClearTexSubImage(Texture, 0, tiles[face].x, tiles[face].y, 0, size, size, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &farDepth);
+	}
+}
+
+int EShadowAtlas::tierFor(float coverage, int currentTier)
+{
+	int tier = tierCount - 1;
+	for (int t = 0; t < tierCount; t++)
+	{
+		if (coverage >= tierCoverage[t]) {
+			tier = t;
+			break;
+		}
+	}
+	if (currentTier >= 0 && tier > currentTier && coverage >= tierCoverage[currentTier] * 0.8f) {
+		tier = currentTier;
+	}
+	return tier;
+}
+
+bool EShadowAtlas::allocate(int tier, ivec2& corner)
+{
+	if (!freeTiles[tier].empty()) {
+		corner = freeTiles[tier].back();
+		freeTiles[tier].pop_back();
+		return true;
+	}
+
+	// split a free tile of the next larger size into four
+	ivec2 parent;
+	if (tier == 0 || !allocate(tier - 1, parent)) {
+		return false;
+	}
+	int size = tierSizes[tier];
+	freeTiles[tier].push_back(parent + ivec2(size, 0));
+	freeTiles[tier].push_back(parent + ivec2(0, size));
+	freeTiles[tier].push_back(parent + ivec2(size, size));
+	corner = parent;
+	return true;
+}
+
+void EShadowAtlas::release(int tier, ivec2 corner)
+{
+	if (tier > 0) {
+		int size = tierSizes[tier];
+		ivec2 parent = corner / tierSizes[tier - 1] * tierSizes[tier - 1];
+		vector<ivec2>& tiles = freeTiles[tier];
+
+		// merge if the three siblings of the tile are free
+		int freeSiblings = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			ivec2 sibling = parent + ivec2(i % 2, i / 2) * size;
+			if (sibling != corner && find(tiles.begin(), tiles.end(), sibling) != tiles.end()) {
+				freeSiblings++;
+			}
+		}
+		if (freeSiblings == 3) {
+			for (int i = 0; i < 4; i++)
+			{
+				ivec2 sibling = parent + ivec2(i % 2, i / 2) * size;
+				tiles.erase(remove(tiles.begin(), tiles.end(), sibling), tiles.end());
+			}
+			release(tier - 1, parent);
+			return;
+		}
+	}
+	freeTiles[tier].push_back(corner);
+}
+
+void EShadowAtlas::releaseLamp(Allocation& allocation)
+{
+	if (allocation.tier >= 0) {
+		for (int face = 0; face < allocation.faces; face++)
+		{
+			release(allocation.tier, allocation.tiles[face]);
+		}
+	}
+	allocation.tier = -1;
+}
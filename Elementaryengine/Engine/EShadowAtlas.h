@@ -0,0 +1,88 @@
+#pragma once
+#include <EEngine.h>
+#include <EStreamBuffer.h>
+#include <vector>
+#include <unordered_map>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+class Lamp;
+
+///<summary>
+///one depth texture shared by the shadows of all lamps. Every point lamp gets six square tiles, one per cube face, and every spot lamp one,
+///with a size picked from how large its range is on screen, lamps whose range is out of view get none. The cascades of the sun keep tiles of the largest size. The tiles come from a buddy allocator, lamps keep theirs while their size
+///doesn't change and only the lamps that got new tiles have to be rendered again
+///</summary>
+class DllExport EShadowAtlas
+{
+public:
+	///<summary>
+	///creates the texture, size x size texels, and reserves the tiles of the sun cascades
+	///</summary>
+	void Initialize(unsigned int size, int sunCascades);
+
+	///<summary>
+	///assigns the tiles for this frame and copies them to the GPU. Lamps that got new tiles are marked dirty
+	///</summary>
+	void Update(const vector<Lamp*>& lamps, float range, const mat4& view, const mat4& projection);
+
+	///<summary>
+	///sets the viewports from 0 on to the faces of the lamp, the lightmap geometry shader selects them by face
+	///</summary>
+	void SetViewports(Lamp* lamp);
+
+	///<summary>
+	///clears the tiles of the lamp to the far depth
+	///</summary>
+	void ClearTiles(Lamp* lamp);
+
+	///<summary>
+	///sets the viewports from 0 on to the cascades of the sun and clears them
+	///</summary>
+	void BeginSun();
+
+	// the lamps that have tiles, in the order they are given to Update
+	vector<Lamp*> Casters;
+	GLuint Texture = 0;
+	unsigned int Size = 0;
+	// the tiles of the cascades of the sun, of the largest tier
+	vector<ivec2> SunTiles;
+
+	// tile sizes in texels, the largest one is the size of the root blocks of the allocator
+	static const int tierCount = 4;
+	static const int tierSizes[tierCount];
+	// a lamp needs its range to cover at least this part of the screen height for a tier
+	static const float tierCoverage[tierCount];
+
+	// binding point of the tiles of every lamp, six vec4 (corner, size, 0) in texture coordinates
+	static const int tileBinding = 18;
+
+private:
+	struct Allocation
+	{
+		// the tier the lamp has tiles of and the one it should have, they differ when the atlas was full
+		int tier = -1;
+		int wanted = -1;
+		// 6 for point lamps, 1 for spot lamps
+		int faces = 6;
+		ivec2 tiles[6];
+	};
+
+	// picks the tier for the part of the screen the lamp covers, a lamp only drops to a smaller tier once it is clearly below the threshold
+	int tierFor(float coverage, int currentTier);
+	bool allocate(int tier, ivec2& corner);
+	// frees the tile and merges it with its siblings if they are all free
+	void release(int tier, ivec2 corner);
+	void releaseLamp(Allocation& allocation);
+	void setViewports(const ivec2* tiles, int count, int size);
+	void clearTiles(const ivec2* tiles, int count, int size);
+
+	unordered_map<Lamp*, Allocation> allocations;
+	// free tiles of every tier
+	vector<ivec2> freeTiles[tierCount];
+	EStreamBuffer tileSSBO{ GL_SHADER_STORAGE_BUFFER };
+};
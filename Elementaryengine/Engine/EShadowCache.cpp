@@ -0,0 +1,131 @@
+#include "EShadowCache.h"
+#include <Game.h>
+#include <limits>
+
+vector<vec4> EShadowCache::movedSpheres;
+unordered_map<Asset*, vec4> EShadowCache::assetSpheres;
+bool EShadowCache::invalidated = true;
+
+void EShadowCache::AllocateCubeMaps(GLuint& shadowMaps, unsigned int width, unsigned int height)
+{
+	// immutable storage can't be resized, a new texture is made when the number of lamps changed
+	int lampCount = (int)Game::lamps.size();
+	if (lampCount != allocatedLamps || width != allocatedWidth || height != allocatedHeight) {
+		glDeleteTextures(1, &shadowMaps);
+		glGenTextures(1, &shadowMaps);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, shadowMaps);
+		glTexStorage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 1, GL_DEPTH_COMPONENT32, width, height, 6 * (std::max)(1, lampCount));
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LESS);
+		glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, 0);
+		allocatedLamps = lampCount;
+		allocatedWidth = width;
+		allocatedHeight = height;
+		invalidated = true;
+	}
+}
+
+void EShadowCache::Update(const vector<Lamp*>& casters, float range)
+{
+	// the layers of the lamps moved if a lamp was added, removed or stopped throwing shadows
+	if (IndexedLayers && casters != Casters) {
+		invalidated = true;
+	}
+	Casters = casters;
+
+	// every asset starts from the sphere it is at now, this also drops the destroyed ones
+	if (invalidated) {
+		assetSpheres.clear();
+		for each (Mesh* m in Game::meshs)
+		{
+			for each (Asset* a in m->parents)
+			{
+				assetSpheres[a] = assetSphere(a);
+			}
+		}
+	}
+
+	// vertices of soft bodies move without their asset, their bounds follow the vertices
+	for each (Mesh* m in Game::meshs)
+	{
+		if (m->dynamicVertices) {
+			for each (Asset* a in m->parents)
+			{
+				vec4 sphere = assetSphere(a);
+				auto last = assetSpheres.find(a);
+				if (last == assetSpheres.end() || last->second != sphere) {
+					AssetChanged(a);
+				}
+			}
+		}
+	}
+
+	AnyDirty = false;
+	for each (Lamp* l in Casters)
+	{
+		vec3 lightPos = l->parents[0]->position;
+		vec4 cone = l->getCone();
+		if (invalidated || lightPos != l->shadowPosition || cone != l->shadowDirection) {
+			l->shadowDirty = true;
+		}
+		for (size_t i = 0; i < movedSpheres.size() && !l->shadowDirty; i++)
+		{
+			if (movedSpheres[i].w >= 0 && distance(vec3(movedSpheres[i]), lightPos) <= range + movedSpheres[i].w) {
+				l->shadowDirty = true;
+			}
+		}
+		l->shadowPosition = lightPos;
+		l->shadowDirection = cone;
+		AnyDirty |= l->shadowDirty;
+	}
+	movedSpheres.clear();
+	invalidated = false;
+}
+
+void EShadowCache::ClearLayer(GLuint shadowMaps, int layer)
+{
+	float farDepth = 1.0f;
+	glClearTexSubImage(shadowMaps, 0, 0, 0, 6 * layer, allocatedWidth, allocatedHeight, 6, GL_DEPTH_COMPONENT, GL_FLOAT, &farDepth);
+}
+
+void EShadowCache::AssetChanged(Asset * asset)
+{
+	vec4 sphere = assetSphere(asset);
+	auto last = assetSpheres.find(asset);
+	if (last != assetSpheres.end()) {
+		movedSpheres.push_back(last->second);
+	}
+	movedSpheres.push_back(sphere);
+	assetSpheres[asset] = sphere;
+}
+
+void EShadowCache::InvalidateAll()
+{
+	invalidated = true;
+}
+
+vec4 EShadowCache::assetSphere(Asset * asset)
+{
+	vec4 sphere = vec4(asset->position, -1);
+	for each (AssetComponent* com in asset->components)
+	{
+		Mesh* m = dynamic_cast<Mesh*>(com);
+		if (m == nullptr) {
+			continue;
+		}
+		// meshes without bounds could be anywhere around the asset
+		if (m->bounds.w < 0) {
+			sphere.w = numeric_limits<float>::infinity();
+			continue;
+		}
+		vec3 scale = asset->scale + m->scaleOffset;
+		vec3 center = asset->position + m->posOffset + scale * (asset->q * vec3(m->bounds));
+		float radius = m->bounds.w * (std::max)(abs(scale.x), (std::max)(abs(scale.y), abs(scale.z)));
+		sphere.w = (std::max)(sphere.w, distance(center, asset->position) + radius);
+	}
+	return sphere;
+}
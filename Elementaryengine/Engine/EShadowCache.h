@@ -0,0 +1,67 @@
+#pragma once
+#include <EEngine.h>
+#include <vector>
+#include <unordered_map>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+class Asset;
+class Lamp;
+
+///<summary>
+///keeps the shadow maps between frames. A lamp is marked dirty when it moved or when a caster moved inside its range, the other lamps keep
+///the shadows of the last frame. Also holds the immutable cube map array of the renderers that give every lamp a layer
+///</summary>
+class DllExport EShadowCache
+{
+public:
+	///<summary>
+	///(re)allocates the cube map array if the lamp count changed, every lamp is dirty after that
+	///</summary>
+	void AllocateCubeMaps(GLuint& shadowMaps, unsigned int width, unsigned int height);
+
+	///<summary>
+	///sets the shadowDirty flag of the casters whose shadows have to be rendered again. Call once per frame before rendering the shadows
+	///</summary>
+	void Update(const vector<Lamp*>& casters, float range);
+
+	///<summary>
+	///clears the six faces of a cube map array layer to the far depth
+	///</summary>
+	void ClearLayer(GLuint shadowMaps, int layer);
+
+	///<summary>
+	///marks the lamps around the old and the new bounds of the asset dirty, called by the asset changed callback of the renderer
+	///</summary>
+	static void AssetChanged(Asset* asset);
+
+	///<summary>
+	///marks every lamp dirty, for assets that were created or destroyed
+	///</summary>
+	static void InvalidateAll();
+
+	// the casters given to the last update
+	vector<Lamp*> Casters;
+	// true if at least one caster has to be rendered
+	bool AnyDirty = false;
+	// the layer of a caster is its index, so a changed list of casters moves the layers
+	bool IndexedLayers = true;
+
+private:
+	// world space sphere around all meshes of the asset, w < 0 if it has none
+	static vec4 assetSphere(Asset* asset);
+
+	// the spheres the changed assets left and entered since the last update
+	static vector<vec4> movedSpheres;
+	// the sphere every asset was at when it last changed
+	static unordered_map<Asset*, vec4> assetSpheres;
+	static bool invalidated;
+
+	int allocatedLamps = -1;
+	unsigned int allocatedWidth = 0;
+	unsigned int allocatedHeight = 0;
+};
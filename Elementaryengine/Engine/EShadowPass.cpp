@@ -24,51 +24,72 @@ EShadowPass::~EShadowPass()
 
 void EShadowPass::Render()
 {
-	ERenderPass::Render();
 	meshCount = Game::eOpenGl->instance;
-	// the number of lights in the Game
-	int lightcount = Game::lamps.size();
 
-	// bind the cubemap array containing the shadowmap
-	glBindTexture(GL_TEXTURE_CUBE_MAP_ARRAY, ShadowMaps);
+	// the lamps in view get tiles in the atlas, the tiles of the lamps that didn't change keep their shadows
+	atlas.Update(Game::lamps, farPlane, Game::View, Game::Projection);
+	shadowCache.Update(atlas.Casters, farPlane);
+	Game::eOpenGl->shadowMaps = ShadowMaps;
 
-	// setup the texture array to resize to fit all the lights in the scene
-	glTexImage3D(GL_TEXTURE_CUBE_MAP_ARRAY, 0, GL_DEPTH_COMPONENT32, shadowMapWidth, shadowMapHeight, 6 * lightcount, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LESS);
+	// the cascades follow the camera, so the sun is rendered every frame while it shines
+	bool sun = !atlas.SunTiles.empty() && Game::directionalLightColor != vec3(0) && Game::directionalLightDirection != vec3(0);
+	if (sun) {
+		fitCascades();
+	}
+	else {
+		sunCascades.clear();
+	}
+	sunSSBO.Write(sunCascades.data(), sizeof(SunCascade) * sunCascades.size(), 20);
+
+	vector<Lamp*> dirty;
+	for each (Lamp* l in shadowCache.Casters)
+	{
+		if (l->shadowDirty) {
+			dirty.push_back(l);
+		}
+	}
+	if (dirty.empty() && !sun) {
+		return;
+	}
 
-	// change the viewport to the resolution of the shadowmaps
-	glViewport(0, 0, shadowMapWidth, shadowMapHeight);
+	bool culled = CullCasters && meshCount > 0;
+	if (culled) {
+		cullCasters(dirty, sun);
+	}
+	ERenderPass::Render();
 
-	// bind the Texture array to framebuffer and clear it
+	// bind the atlas to framebuffer
 	glBindFramebuffer(GL_FRAMEBUFFER, renderBuffer);
 	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, ShadowMaps, 0);
-	glClearDepth(1);
-	glClear(GL_DEPTH_BUFFER_BIT);
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
+	if (shadowUniformShadowMatrices < 0) {
+		shadowUniformShadowMatrices = glGetUniformLocation(_shader->ID, "shadowMatrices");
+	}
 
-	// render each lamp to a layer
-	int currentLayer = 0;
-	for each (Lamp* l in Game::lamps)
+	// render the lamps that are new or moved or have a caster in their range that moved to their tiles
+	uniformDirectional.Update(false);
+	for (unsigned int i = 0; i < dirty.size(); i++)
 	{
+		Lamp* l = dirty[i];
+		l->shadowDirty = false;
+		atlas.ClearTiles(l);
+		atlas.SetViewports(l);
 
-		// only rerender the layer if a shadowmap is needed
-		if (l->throwShadows) {
-
-			// create the projection matrix
-
-			// aspect ratio of the shadowMaps
-			float aspect = (float)shadowMapWidth / (float)shadowMapHeight;
-
-			// projection matrix fot the shadow map
-			glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), aspect, nearPlane, farPlane);
-			vec3 lightPos = l->parents[0]->position;
+		vec3 lightPos = l->parents[0]->position;
+		std::vector<glm::mat4> shadowTransforms;
+		if (l->type == spotLamp) {
+			// one view along the axis of the cone, with the up vector the illumination pass projects with
+			vec3 direction = normalize(l->Direction);
+			vec3 up = abs(direction.y) > 0.99f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+			glm::mat4 shadowProj = glm::perspective(glm::radians(2 * l->getSpotAngle()), 1.0f, nearPlane, farPlane);
+			shadowTransforms.push_back(shadowProj * glm::lookAt(lightPos, lightPos + direction, up));
+		}
+		else {
+			// projection matrix fot the shadow map, the tiles are square
+			glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
 
 			// transform matricies for the shadow map
-			std::vector<glm::mat4> shadowTransforms;
 			shadowTransforms.push_back(shadowProj *
 				glm::lookAt(lightPos, lightPos + glm::vec3(1.0, 0.0, 0.0), glm::vec3(0.0, -1.0, 0.0)));
 			shadowTransforms.push_back(shadowProj *
@@ -81,30 +102,166 @@ void EShadowPass::Render()
 				glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, 1.0), glm::vec3(0.0, -1.0, 0.0)));
 			shadowTransforms.push_back(shadowProj *
 				glm::lookAt(lightPos, lightPos + glm::vec3(0.0, 0.0, -1.0), glm::vec3(0.0, -1.0, 0.0)));
+		}
 
-			unifromCurrentLayer.Update(currentLayer);
-
-			// copy the created shadow matrix to the GPU
-			if (shadowUniformShadowMatrices < 0) {
-				shadowUniformShadowMatrices = glGetUniformLocation(_shader->ID, "shadowMatrices");
-			}
-			glUniformMatrix4fv(shadowUniformShadowMatrices, shadowTransforms.size(), GL_FALSE, glm::value_ptr(shadowTransforms[0]));
-			currentLayer++;
-			unifromCurrentLightPosition.Update(lightPos);
-
-			glBindVertexArray(VAO);
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ElementBuffer);
-			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, IndirectBuffer);
-
-			glMultiDrawElementsIndirect(GL_TRIANGLES,
-				GL_UNSIGNED_INT,
-				(GLvoid*)0,
-				meshCount,
-				0);
+		// copy the created shadow matrix to the GPU
+		uniformFaceCount.Update((int)shadowTransforms.size());
+		glUniformMatrix4fv(shadowUniformShadowMatrices, shadowTransforms.size(), GL_FALSE, glm::value_ptr(shadowTransforms[0]));
+		unifromCurrentLightPosition.Update(lightPos);
+		drawCasters(i, culled);
+	}
+
+	// the cascades of the sun, casters between the sun and the near plane are clamped onto it
+	if (sun) {
+		atlas.BeginSun();
+		vector<mat4> cascadeMatrices;
+		for each (SunCascade c in sunCascades)
+		{
+			cascadeMatrices.push_back(c.matrix);
 		}
+		uniformDirectional.Update(true);
+		uniformFaceCount.Update((int)cascadeMatrices.size());
+		glUniformMatrix4fv(shadowUniformShadowMatrices, cascadeMatrices.size(), GL_FALSE, glm::value_ptr(cascadeMatrices[0]));
+		glEnable(GL_DEPTH_CLAMP);
+		drawCasters((unsigned int)dirty.size(), culled);
+		glDisable(GL_DEPTH_CLAMP);
 	}
 	glBindTexture(GL_TEXTURE_2D, 0);
-	Game::eOpenGl->shadowMaps = ShadowMaps;
+}
+
+void EShadowPass::drawCasters(unsigned int list, bool culled)
+{
+	if (culled) {
+		// the commands of this list, they draw the casters listed for it
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, shadowIndirectBuffer);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, shadowVisibleBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES,
+			GL_UNSIGNED_INT,
+			(GLvoid*)(list * meshCount * sizeof(DrawElementsIndirectCommand)),
+			meshCount,
+			0);
+	}
+	else {
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, IndirectBuffer);
+		glMultiDrawElementsIndirect(GL_TRIANGLES,
+			GL_UNSIGNED_INT,
+			(GLvoid*)0,
+			meshCount,
+			0);
+	}
+}
+
+void EShadowPass::fitCascades()
+{
+	int count = (int)atlas.SunTiles.size();
+	float tileSize = (float)EShadowAtlas::tierSizes[0];
+	vec3 toSun = normalize(Game::directionalLightDirection);
+	vec3 up = abs(toSun.y) > 0.99f ? vec3(1, 0, 0) : vec3(0, 1, 0);
+	mat4 lightView = glm::lookAt(vec3(0), -toSun, up);
+
+	// the camera frustum from its projection
+	mat4 invView = inverse(Game::View);
+	vec3 eye = vec3(invView[3]);
+	vec3 forward = -normalize(vec3(invView[2]));
+	float tanX = 1.0f / Game::Projection[0][0];
+	float tanY = 1.0f / Game::Projection[1][1];
+	float cameraNear = Game::Projection[3][2] / (Game::Projection[2][2] - 1.0f);
+
+	sunCascades.clear();
+	float sliceNear = cameraNear;
+	for (int c = 0; c < count; c++)
+	{
+		// the slices get longer with the distance, half logarithmic and half uniform
+		float t = (float)(c + 1) / count;
+		float sliceFar = 0.5f * cameraNear * pow(SunShadowDistance / cameraNear, t) + 0.5f * (cameraNear + (SunShadowDistance - cameraNear) * t);
+
+		// the sphere around the slice, centered on the view axis. Its size doesn't change when the camera turns
+		float center = (sliceNear + sliceFar) / 2;
+		float spread = tanX * tanX + tanY * tanY;
+		float radius = (std::max)(sqrt(pow(center - sliceNear, 2.0f) + sliceNear * sliceNear * spread), sqrt(pow(sliceFar - center, 2.0f) + sliceFar * sliceFar * spread));
+
+		// move the center in whole texels of the cascade so the shadow edges don't swim while the camera moves
+		float texel = 2 * radius / tileSize;
+		vec3 lightCenter = vec3(lightView * vec4(eye + forward * center, 1));
+		lightCenter.x = floor(lightCenter.x / texel) * texel;
+		lightCenter.y = floor(lightCenter.y / texel) * texel;
+		vec3 sphereCenter = vec3(inverse(lightView) * vec4(lightCenter, 1));
+
+		SunCascade cascade;
+		mat4 view = glm::lookAt(sphereCenter + toSun * sunReach, sphereCenter, up);
+		cascade.matrix = glm::ortho(-radius, radius, -radius, radius, 0.0f, sunReach + radius) * view;
+		cascade.tile = vec4(vec2(atlas.SunTiles[c]) / (float)atlas.Size, tileSize / atlas.Size, 1.5f * texel / (sunReach + radius));
+		cascade.sphere = vec4(sphereCenter, radius);
+		sunCascades.push_back(cascade);
+		sliceNear = sliceFar;
+	}
+}
+
+void EShadowPass::cullCasters(const vector<Lamp*>& casters, bool sun)
+{
+	EOpenGl* eOpenGl = Game::eOpenGl;
+	size_t commandCount = eOpenGl->dICommands.size();
+	size_t instanceCount = eOpenGl->instanceDraw.size();
+	size_t lampCount = casters.size() + (sun ? 1 : 0);
+
+	// one list per lamp
+	if (lampCount * commandCount > shadowIndirectCapacity) {
+		shadowIndirectCapacity = lampCount * commandCount;
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, shadowIndirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, shadowIndirectCapacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_COPY);
+	}
+	if (lampCount * instanceCount > shadowVisibleCapacity) {
+		shadowVisibleCapacity = lampCount * instanceCount;
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, shadowVisibleBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, shadowVisibleCapacity * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+
+	// position and cone of every lamp, the sun is marked by w = 1 and tested against the cascades
+	vector<vec4> lamps;
+	for each (Lamp* l in casters)
+	{
+		lamps.push_back(vec4(l->parents[0]->position, 0));
+		lamps.push_back(l->getCone());
+	}
+	vector<vec4> cascades;
+	if (sun) {
+		lamps.push_back(vec4(0, 0, 0, 1));
+		lamps.push_back(vec4(0, 0, 0, -1));
+		for each (SunCascade c in sunCascades)
+		{
+			cascades.push_back(c.sphere);
+		}
+	}
+	lampSSBO.Write(lamps.data(), sizeof(vec4) * lamps.size(), 17);
+
+	cullShader->use();
+	uniformCullRange.Update(farPlane);
+	uniformCullCascadeCount.Update((int)cascades.size());
+	if (sun) {
+		if (cullUniformCascades < 0) {
+			cullUniformCascades = glGetUniformLocation(cullShader->ID, "cascades");
+		}
+		glUniform4fv(cullUniformCascades, cascades.size(), glm::value_ptr(cascades[0]));
+		uniformCullSunDirection.Update(normalize(Game::directionalLightDirection));
+		uniformCullSunReach.Update(sunReach);
+	}
+	uniformCullCommandCount.Update((int)commandCount);
+	uniformCullInstanceCount.Update((int)instanceCount);
+	uniformCullLampCount.Update((int)lampCount);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 14, shadowVisibleBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 15, IndirectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 16, shadowIndirectBuffer);
+
+	// copy the commands for every lamp, then add the casters of every lamp
+	uniformCullStage.Update(0);
+	glDispatchCompute((GLuint)((lampCount * commandCount + 63) / 64), 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	if (instanceCount > 0) {
+		uniformCullStage.Update(1);
+		glDispatchCompute((GLuint)((lampCount * instanceCount + 63) / 64), 1, 1);
+	}
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
 }
 
 void EShadowPass::Initialize()
@@ -112,17 +269,34 @@ void EShadowPass::Initialize()
 	_shader = Mesh::lightmapShader;
 
 	// Shadow uniforms
-	unifromCurrentLayer = EOGLUniform<int>(_shader, "layer", 0);
 	unifromCurrentLightPosition = EOGLUniform<vec3>(_shader, "lightPos", vec3(0));
 
 	_uniforms.push_back(new EOGLUniform<int>(_shader, "gPosition", 0));
 	_uniforms.push_back(new EOGLUniform<float>(_shader, "far_plane", farPlane));
 
+	uniformFaceCount = EOGLUniform<int>(_shader, "faceCount", 6);
+	uniformDirectional = EOGLUniform<bool>(_shader, "directional", false);
+
 	ERenderPass::Initialize();
 
-	glGenTextures(1, &ShadowMaps);
-	shadowMapWidth = Lamp::SHADOW_WIDTH;
-	shadowMapHeight = Lamp::SHADOW_HEIGHT;
+	// at most six cascades, one per viewport the geometry shader selects
+	SunCascades = (std::max)(0, (std::min)(SunCascades, 6));
+	atlas.Initialize(AtlasSize, SunCascades);
+	ShadowMaps = atlas.Texture;
+	shadowCache.IndexedLayers = false;
+
+	// caster culling
+	cullShader = new Shader("..\\shaders\\ShadowCull.comp");
+	uniformCullStage = EOGLUniform<int>(cullShader, "stage", 0);
+	uniformCullCommandCount = EOGLUniform<int>(cullShader, "commandCount", 0);
+	uniformCullInstanceCount = EOGLUniform<int>(cullShader, "instanceCount", 0);
+	uniformCullLampCount = EOGLUniform<int>(cullShader, "lampCount", 0);
+	uniformCullRange = EOGLUniform<float>(cullShader, "range", farPlane);
+	uniformCullCascadeCount = EOGLUniform<int>(cullShader, "cascadeCount", 0);
+	uniformCullSunDirection = EOGLUniform<vec3>(cullShader, "sunDirection", vec3(0, 1, 0));
+	uniformCullSunReach = EOGLUniform<float>(cullShader, "sunReach", sunReach);
+	glGenBuffers(1, &shadowIndirectBuffer);
+	glGenBuffers(1, &shadowVisibleBuffer);
 
 
 
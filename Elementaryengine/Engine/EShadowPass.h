@@ -1,7 +1,15 @@
 #pragma once
 #include "ERenderPass.h"
+#include <EShadowCache.h>
+#include <EShadowAtlas.h>
 #define OUT
 
+class Lamp;
+
+///<summary>
+///renders the shadows of the lamps and the cascades of the sun into the shadow atlas. Point lamps render the six faces of a cube,
+///spot lamps a single view along their cone and the sun one orthographic view per cascade
+///</summary>
 class EShadowPass :
 	public ERenderPass
 {
@@ -15,17 +23,74 @@ public:
 	virtual void Render();
 	virtual void Initialize();
 
+	// the shadow atlas texture
 	GLuint ShadowMaps;
+	// size of the atlas in texels
+	unsigned int AtlasSize = 4096;
+	// number of cascades of the sun (up to 6, 0 for no sun shadows) and how far from the camera they reach
+	int SunCascades = 4;
+	float SunShadowDistance = 100.0f;
 
 
 	GLuint VAO;
 	GLuint ElementBuffer;
 	GLuint IndirectBuffer;
+
+	// cull the casters per lamp against its range and per cube face on the GPU, needs the culling input of the modular rasterizer
+	bool CullCasters = false;
 private:
-	uint shadowMapWidth;
-	uint shadowMapHeight;
-	EOGLUniform<int> unifromCurrentLayer;
+	///<summary>
+	///writes a list of draw commands for every lamp, with only the casters in its range and the faces they are in, and one for the sun
+	///with the cascades its casters are in after them
+	///</summary>
+	void cullCasters(const vector<Lamp*>& casters, bool sun);
+
+	///<summary>
+	///draws the casters of a lamp, list is its index in the lists of cullCasters
+	///</summary>
+	void drawCasters(unsigned int list, bool culled);
+
+	///<summary>
+	///splits the view up to SunShadowDistance into the cascades and fits a sphere and an orthographic view to each
+	///</summary>
+	void fitCascades();
+
+	// what the illumination pass needs to sample a cascade
+	struct SunCascade
+	{
+		mat4 matrix;
+		// corner and size in the atlas, depth bias
+		vec4 tile;
+		vec4 sphere;
+	};
+	vector<SunCascade> sunCascades;
+	EStreamBuffer sunSSBO{ GL_SHADER_STORAGE_BUFFER };
+	// how far in front of a cascade towards the sun casters are drawn
+	float sunReach = 100.0f;
+
+	// only the lamps that changed are rendered again
+	EShadowCache shadowCache;
+	EShadowAtlas atlas;
+
+	Shader* cullShader;
+	EOGLUniform<int> uniformCullStage;
+	EOGLUniform<int> uniformCullCommandCount;
+	EOGLUniform<int> uniformCullInstanceCount;
+	EOGLUniform<int> uniformCullLampCount;
+	EOGLUniform<float> uniformCullRange;
+	EOGLUniform<int> uniformCullCascadeCount;
+	EOGLUniform<vec3> uniformCullSunDirection;
+	EOGLUniform<float> uniformCullSunReach;
+	int cullUniformCascades = -1;
+	EStreamBuffer lampSSBO{ GL_SHADER_STORAGE_BUFFER };
+	GLuint shadowIndirectBuffer = 0;
+	GLuint shadowVisibleBuffer = 0;
+	// sizes of the buffers in commands and instances
+	size_t shadowIndirectCapacity = 0;
+	size_t shadowVisibleCapacity = 0;
 	EOGLUniform<vec3> unifromCurrentLightPosition;
+	EOGLUniform<int> uniformFaceCount;
+	EOGLUniform<bool> uniformDirectional;
 	float nearPlane = 1.0f;
 	float farPlane = 25.0f;
 
@@ -0,0 +1,365 @@
+#include "ESoftBody.h"
+#include <Game.h>
+#include <EJobSystem.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm\gtx\quaternion.hpp>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <tuple>
+
+vector<ESoftBody*> ESoftBody::instances;
+mutex ESoftBody::stagingMutex;
+
+// same transform the renderer applies to the vertices of the asset's meshes
+static mat4 AssetModel(Asset* asset)
+{
+	mat4 model = translate(mat4(1.0f), asset->getPosition());
+	model = glm::scale(model, asset->getScale());
+	return model * glm::toMat4(asset->q);
+}
+
+ESoftBody::ESoftBody(Asset * asset, Mesh * mesh, const ESoftBodySettings & settings)
+{
+	btSoftRigidDynamicsWorld* world = dynamic_cast<btSoftRigidDynamicsWorld*>(Game::dynamicsWorld);
+	if (world == nullptr) {
+		Game::console.Print("soft bodies need a soft body world, see EPhysicsSettings::softBodies");
+		return;
+	}
+	owner = asset;
+
+	// weld the split vertices, every position becomes one node
+	mat4 model = AssetModel(asset);
+	map<tuple<float, float, float>, int> nodeIndices;
+	vector<btVector3> nodePositions;
+	vertexNodes.reserve(mesh->vertices.size());
+	for each (Vertex v in mesh->vertices)
+	{
+		tuple<float, float, float> key(v.Position.x, v.Position.y, v.Position.z);
+		auto found = nodeIndices.find(key);
+		if (found == nodeIndices.end()) {
+			found = nodeIndices.insert(make_pair(key, (int)nodePositions.size())).first;
+			nodePositions.push_back(Game::toBullet(vec3(model * vec4(v.Position, 1))));
+		}
+		vertexNodes.push_back(found->second);
+	}
+
+	softBody = new btSoftBody(&world->getWorldInfo(), (int)nodePositions.size(), nodePositions.data(), nullptr);
+	btSoftBody::Material* material = softBody->m_materials[0];
+	material->m_kLST = settings.stiffness;
+
+	// one link per edge, shared edges only once
+	set<pair<int, int>> edges;
+	for (size_t i = 0; i + 2 < mesh->indices.size(); i += 3)
+	{
+		int n[3] = { vertexNodes[mesh->indices[i]], vertexNodes[mesh->indices[i + 1]], vertexNodes[mesh->indices[i + 2]] };
+		if (n[0] == n[1] || n[1] == n[2] || n[0] == n[2])
+			continue;
+		for (int e = 0; e < 3; e++)
+		{
+			int a = n[e];
+			int b = n[(e + 1) % 3];
+			if (edges.insert(make_pair(a < b ? a : b, a < b ? b : a)).second) {
+				softBody->appendLink(a, b);
+			}
+		}
+		if (settings.type != softRope) {
+			softBody->appendFace(n[0], n[1], n[2]);
+		}
+	}
+
+	softBody->m_cfg.piterations = settings.iterations;
+	softBody->m_cfg.kDF = settings.friction;
+	softBody->m_cfg.collisions |= btSoftBody::fCollision::VF_SS;
+	switch (settings.type)
+	{
+	case softCloth:
+		softBody->generateBendingConstraints(2, material);
+		break;
+	case softVolume:
+		softBody->m_cfg.kPR = settings.pressure;
+		break;
+	default:
+		break;
+	}
+	softBody->setTotalMass(settings.mass, settings.type != softRope);
+	softBody->setUserPointer(asset);
+
+	// a copy of the mesh, the vertices are written in the local space of the asset
+	this->mesh = new Mesh(mesh->vertices, mesh->indices, vector<Texture*>());
+	this->mesh->material = mesh->material;
+	this->mesh->posOffset = vec3(0);
+	this->mesh->rotOffset = vec3(0);
+	this->mesh->scaleOffset = vec3(0);
+	this->mesh->dynamicVertices = true;
+	this->mesh->attachTo(asset);
+	attachTo(asset);
+
+	lock_guard<mutex> lock(Game::physicsMutex);
+	world->addSoftBody(softBody, ECollisionLayers::Group(settings.collisionLayer), ECollisionLayers::Mask(settings.collisionLayer));
+	instances.push_back(this);
+}
+
+ESoftBody::~ESoftBody()
+{
+	{
+		lock_guard<mutex> lock(Game::physicsMutex);
+		removeBody();
+		instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+	}
+	// the asset must not keep pointers to the component and its mesh
+	for each (Asset* a in parents)
+	{
+		a->components.erase(std::remove(a->components.begin(), a->components.end(), this), a->components.end());
+		if (mesh != nullptr) {
+			a->components.erase(std::remove(a->components.begin(), a->components.end(), mesh), a->components.end());
+		}
+	}
+	if (mesh != nullptr) {
+		Game::meshs.erase(std::remove(Game::meshs.begin(), Game::meshs.end(), mesh), Game::meshs.end());
+		delete mesh;
+	}
+}
+
+void ESoftBody::pin(vec3 point, float radius)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	if (softBody == nullptr)
+		return;
+	btVector3 center = Game::toBullet(point);
+	for (int i = 0; i < softBody->m_nodes.size(); i++)
+	{
+		if (softBody->m_nodes[i].m_x.distance2(center) <= radius * radius) {
+			softBody->setMass(i, 0);
+		}
+	}
+}
+
+void ESoftBody::anchor(Asset * asset, vec3 point, float radius)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	btRigidBody* body = asset->getRigidBody();
+	if (softBody == nullptr || body == nullptr)
+		return;
+	btVector3 center = Game::toBullet(point);
+	for (int i = 0; i < softBody->m_nodes.size(); i++)
+	{
+		if (softBody->m_nodes[i].m_x.distance2(center) <= radius * radius) {
+			softBody->appendAnchor(i, body);
+		}
+	}
+}
+
+void ESoftBody::addForce(vec3 force)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	if (softBody != nullptr) {
+		softBody->addForce(Game::toBullet(force));
+	}
+}
+
+btSoftBody * ESoftBody::getSoftBody()
+{
+	return softBody;
+}
+
+void ESoftBody::Stage()
+{
+	lock_guard<mutex> lock(stagingMutex);
+	for each (ESoftBody* s in instances)
+	{
+		if (s->softBody == nullptr || !s->softBody->isActive())
+			continue;
+		btSoftBody::tNodeArray& nodes = s->softBody->m_nodes;
+		s->stagedPositions.resize(nodes.size());
+		s->stagedNormals.resize(nodes.size());
+		for (int i = 0; i < nodes.size(); i++)
+		{
+			s->stagedPositions[i] = nodes[i].m_x;
+			s->stagedNormals[i] = nodes[i].m_n;
+		}
+		s->staged = true;
+	}
+}
+
+void ESoftBody::SyncChanged()
+{
+	for each (ESoftBody* s in instances)
+	{
+		{
+			lock_guard<mutex> lock(stagingMutex);
+			if (!s->staged)
+				continue;
+			s->positions.swap(s->stagedPositions);
+			s->normals.swap(s->stagedNormals);
+			s->staged = false;
+		}
+		if (s->mesh->parents.empty())
+			continue;
+
+		// the renderer transforms the vertices with the asset, so undo that
+		mat4 toLocal = inverse(AssetModel(s->mesh->parents[0]));
+		vector<Vertex>& vertices = s->mesh->vertices;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			int node = s->vertexNodes[i];
+			vertices[i].Position = vec3(toLocal * vec4(Game::toGlm(s->positions[node]), 1));
+			vertices[i].Normal = normalize(vec3(toLocal * vec4(Game::toGlm(s->normals[node]), 0)));
+		}
+		// the shadow cache only redraws the lamps the new bounds reach
+		s->mesh->CalculateBounds();
+		s->mesh->verticesChanged = true;
+	}
+}
+
+void ESoftBody::Forget(Asset * asset)
+{
+	vector<ESoftBody*> owned;
+	{
+		lock_guard<mutex> lock(Game::physicsMutex);
+		btRigidBody* body = asset->getRigidBody();
+		for each (ESoftBody* s in instances)
+		{
+			if (s->softBody == nullptr)
+				continue;
+			if (s->owner == asset) {
+				owned.push_back(s);
+				continue;
+			}
+			if (body == nullptr)
+				continue;
+			btAlignedObjectArray<btSoftBody::Anchor>& anchors = s->softBody->m_anchors;
+			for (int i = anchors.size() - 1; i >= 0; i--)
+			{
+				if (anchors[i].m_body == body) {
+					anchors.swap(i, anchors.size() - 1);
+					anchors.pop_back();
+				}
+			}
+		}
+	}
+	// the destructor takes the physics lock itself
+	for each (ESoftBody* s in owned)
+	{
+		delete s;
+	}
+}
+
+void ESoftBody::removeBody()
+{
+	if (softBody == nullptr)
+		return;
+	static_cast<btSoftRigidDynamicsWorld*>(Game::dynamicsWorld)->removeSoftBody(softBody);
+	delete softBody;
+	softBody = nullptr;
+	owner = nullptr;
+	lock_guard<mutex> lock(stagingMutex);
+	staged = false;
+}
+
+void ESoftBodySolver::solveConstraints(float solverdt)
+{
+	vector<btSoftBody*> active;
+	// face arrays of all soft bodies, sorted, to find the body a soft contact points into
+	vector<pair<const btSoftBody::Face*, btSoftBody*>> faceArrays;
+	for (int i = 0; i < m_softBodySet.size(); i++)
+	{
+		btSoftBody* psb = m_softBodySet[i];
+		if (psb->isActive()) {
+			active.push_back(psb);
+		}
+		if (psb->m_faces.size() > 0) {
+			faceArrays.push_back(make_pair(&psb->m_faces[0], psb));
+		}
+	}
+	sort(faceArrays.begin(), faceArrays.end());
+
+	// soft bodies that share a dynamic rigid body (contacts or anchors) or touch each other write to the same data, they go into one group
+	map<const btCollisionObject*, int> objectGroups;
+	// indices into active
+	vector<vector<int>> groups;
+	for (size_t i = 0; i < active.size(); i++)
+	{
+		btSoftBody* psb = active[i];
+		vector<const btCollisionObject*> touched;
+		touched.push_back(psb);
+		for (int c = 0; c < psb->m_rcontacts.size(); c++)
+		{
+			const btRigidBody* rigid = btRigidBody::upcast(psb->m_rcontacts[c].m_cti.m_colObj);
+			if (rigid != nullptr && rigid->getInvMass() != 0) {
+				touched.push_back(rigid);
+			}
+		}
+		for (int a = 0; a < psb->m_anchors.size(); a++)
+		{
+			if (psb->m_anchors[a].m_body->getInvMass() != 0) {
+				touched.push_back(psb->m_anchors[a].m_body);
+			}
+		}
+		for (int c = 0; c < psb->m_scontacts.size(); c++)
+		{
+			auto owner = upper_bound(faceArrays.begin(), faceArrays.end(), make_pair(psb->m_scontacts[c].m_face, (btSoftBody*)nullptr),
+				[](const pair<const btSoftBody::Face*, btSoftBody*>& a, const pair<const btSoftBody::Face*, btSoftBody*>& b) { return less<const btSoftBody::Face*>()(a.first, b.first); });
+			if (owner != faceArrays.begin()) {
+				touched.push_back((owner - 1)->second);
+			}
+		}
+
+		int group = -1;
+		for each (const btCollisionObject* object in touched)
+		{
+			auto found = objectGroups.find(object);
+			if (found == objectGroups.end() || found->second == group)
+				continue;
+			if (group < 0) {
+				group = found->second;
+				continue;
+			}
+			// merge the later group into the earlier one
+			int other = found->second;
+			if (other < group) {
+				int t = other;
+				other = group;
+				group = t;
+			}
+			groups[group].insert(groups[group].end(), groups[other].begin(), groups[other].end());
+			groups[other].clear();
+			for (auto& entry : objectGroups)
+			{
+				if (entry.second == other) {
+					entry.second = group;
+				}
+			}
+		}
+		if (group < 0) {
+			group = (int)groups.size();
+			groups.push_back(vector<int>());
+		}
+		for each (const btCollisionObject* object in touched)
+		{
+			objectGroups[object] = group;
+		}
+		groups[group].push_back((int)i);
+	}
+
+	// within a group in the order of the default solver, so the result does not depend on the grouping or the thread count
+	EJobSystem::ParallelFor((unsigned int)groups.size(), [&groups, &active](unsigned int g) {
+		sort(groups[g].begin(), groups[g].end());
+		for each (int i in groups[g])
+		{
+			active[i]->solveConstraints();
+		}
+	});
+}
+
+void ESoftBodySolver::updateSoftBodies()
+{
+	// integrates the nodes of every body, the bodies don't share nodes
+	btAlignedObjectArray<btSoftBody*>& bodies = m_softBodySet;
+	EJobSystem::ParallelFor((unsigned int)bodies.size(), [&bodies](unsigned int i) {
+		if (bodies[i]->isActive()) {
+			bodies[i]->integrateMotion();
+		}
+	});
+	ESoftBody::Stage();
+}
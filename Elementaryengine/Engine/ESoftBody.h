@@ -0,0 +1,119 @@
+#pragma once
+#include <EEngine.h>
+#include <AssetComponent.h>
+#include <ECollisionLayers.h>
+#include <btBulletDynamicsCommon.h>
+#include <BulletSoftBody\btSoftBody.h>
+#include <BulletSoftBody\btSoftRigidDynamicsWorld.h>
+#include <BulletSoftBody\btDefaultSoftBodySolver.h>
+#include <mutex>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+class Mesh;
+
+///<summary>
+///cloth is a two sided surface with bending constraints, a rope only has the links along the mesh edges, a volume is a closed mesh kept inflated by pressure
+///</summary>
+enum ESoftBodyType { softCloth, softRope, softVolume };
+
+struct DllExport ESoftBodySettings
+{
+	ESoftBodyType type = softCloth;
+	// total mass, spread over the nodes
+	float mass = 1;
+	// linear stiffness of the links, 0 to 1
+	float stiffness = 1;
+	// position solver iterations per step
+	int iterations = 4;
+	float friction = 0.2f;
+	// only used by volumes
+	float pressure = 100;
+	int collisionLayer = ECollisionLayers::defaultLayer;
+};
+
+///<summary>
+///soft body component (cloth, ropes, soft volumes) simulated from mesh data. It renders through its own copy of the mesh, moving vertices only upload
+///the range of that copy in the renderer's geometry pool. Soft bodies are not part of physics snapshots
+///</summary>
+class DllExport ESoftBody :
+	public AssetComponent
+{
+public:
+	///<summary>
+	///creates the soft body from the mesh, placed with the transform of the asset. The copy of the mesh gets attached to the asset
+	///</summary>
+	ESoftBody(Asset* asset, Mesh* mesh, const ESoftBodySettings& settings = ESoftBodySettings());
+	~ESoftBody();
+
+	///<summary>
+	///fixes the nodes within radius of the world space point in place
+	///</summary>
+	void pin(vec3 point, float radius);
+
+	///<summary>
+	///attaches the nodes within radius of the world space point to the rigid body of the asset
+	///</summary>
+	void anchor(Asset* asset, vec3 point, float radius);
+
+	///<summary>
+	///applies the force to every node for the next step
+	///</summary>
+	void addForce(vec3 force);
+
+	btSoftBody* getSoftBody();
+
+	///<summary>
+	///the mesh that shows the simulated vertices
+	///</summary>
+	Mesh* mesh = nullptr;
+
+	///<summary>
+	///copies the node positions and normals of all soft bodies for the next sync. Called on the physics thread after the soft bodies are updated
+	///</summary>
+	static void Stage();
+
+	///<summary>
+	///writes the staged nodes of all soft bodies that moved into their meshes. Call on the game thread
+	///</summary>
+	static void SyncChanged();
+
+	///<summary>
+	///deletes the soft bodies of the asset and removes all anchors to its rigid body, call before the rigid body gets deleted
+	///</summary>
+	static void Forget(Asset* asset);
+
+private:
+	void removeBody();
+
+	btSoftBody* softBody = nullptr;
+	Asset* owner = nullptr;
+	// node of every mesh vertex, the mesh has split vertices at uv and normal seams
+	vector<int> vertexNodes;
+
+	// written by Stage, swapped into the front buffers by SyncChanged, guarded by stagingMutex
+	vector<btVector3> stagedPositions;
+	vector<btVector3> stagedNormals;
+	bool staged = false;
+	vector<btVector3> positions;
+	vector<btVector3> normals;
+
+	static vector<ESoftBody*> instances;
+	static mutex stagingMutex;
+};
+
+///<summary>
+///soft body solver that solves the constraints of independent soft bodies in parallel on the job system.
+///Soft bodies that touch the same dynamic rigid body or each other are solved in one job, in their usual order
+///</summary>
+class DllExport ESoftBodySolver :
+	public btDefaultSoftBodySolver
+{
+public:
+	virtual void solveConstraints(float solverdt);
+	virtual void updateSoftBodies();
+};
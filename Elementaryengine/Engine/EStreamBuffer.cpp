@@ -0,0 +1,114 @@
+#include "EStreamBuffer.h"
+#include <cstring>
+#include <algorithm>
+
+vector<EStreamBuffer*> EStreamBuffer::instances;
+unsigned long long EStreamBuffer::frame = 1;
+deque<pair<unsigned long long, GLsync>> EStreamBuffer::frameFences;
+
+EStreamBuffer::EStreamBuffer(GLenum target)
+{
+	this->target = target;
+}
+
+EStreamBuffer::~EStreamBuffer()
+{
+	instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+	if (buffer != 0) {
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+void EStreamBuffer::Write(const void * data, GLsizeiptr size, GLuint binding)
+{
+	// the first write of a frame takes the next region
+	if (writeFrame != frame) {
+		region = (region + 1) % regionCount;
+		writeOffset = 0;
+		writeFrame = frame;
+		waitForFrame(lastRead[region]);
+	}
+	// a range of size 0 can not be bound
+	if (size <= 0) {
+		glBindBufferBase(target, binding, 0);
+		return;
+	}
+
+	GLsizeiptr start = (writeOffset + alignment - 1) / alignment * alignment;
+	if (buffer == 0 || start + size > regionSize) {
+		// the earlier writes of this frame stay in the old buffer, GL keeps it alive for the draws that use it
+		GLsizeiptr grown = regionSize > 0 ? regionSize * 2 : 64 * 1024;
+		allocate((std::max)(grown, size));
+		start = 0;
+	}
+	GLintptr offset = region * regionSize + start;
+	memcpy(mapped + offset, data, size);
+	writeOffset = start + size;
+	glBindBufferRange(target, binding, buffer, offset, size);
+}
+
+void EStreamBuffer::NextFrame()
+{
+	for each (EStreamBuffer* s in instances)
+	{
+		s->lastRead[s->region] = frame;
+	}
+	frameFences.push_back(make_pair(frame, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)));
+	frame++;
+
+	// forget the frames the GPU already finished
+	while (!frameFences.empty() && glClientWaitSync(frameFences.front().second, 0, 0) != GL_TIMEOUT_EXPIRED)
+	{
+		glDeleteSync(frameFences.front().second);
+		frameFences.pop_front();
+	}
+}
+
+void EStreamBuffer::waitForFrame(unsigned long long frame)
+{
+	// frames finish in order, so the older fences are done too
+	while (!frameFences.empty() && frameFences.front().first <= frame)
+	{
+		GLsync fence = frameFences.front().second;
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(fence);
+		frameFences.pop_front();
+	}
+}
+
+void EStreamBuffer::allocate(GLsizeiptr regionSize)
+{
+	if (buffer == 0) {
+		// registered here and not in the constructor, the renderer buffers are created during static initialisation
+		instances.push_back(this);
+		GLint offsetAlignment = 1;
+		if (target == GL_SHADER_STORAGE_BUFFER) {
+			glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+		}
+		else if (target == GL_UNIFORM_BUFFER) {
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+		}
+		alignment = (std::max)(offsetAlignment, 4);
+	}
+	else {
+		// deleting unmaps it
+		glDeleteBuffers(1, &buffer);
+	}
+
+	// every region starts aligned
+	this->regionSize = (regionSize + alignment - 1) / alignment * alignment;
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(target, buffer);
+	glBufferStorage(target, this->regionSize * regionCount, nullptr, flags);
+	mapped = (char*)glMapBufferRange(target, 0, this->regionSize * regionCount, flags);
+	glBindBuffer(target, 0);
+
+	// nothing reads the new storage yet
+	region = 0;
+	writeOffset = 0;
+	for (int i = 0; i < regionCount; i++)
+	{
+		lastRead[i] = 0;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <EEngine.h>
+#include <deque>
+
+using namespace std;
+
+///<summary>
+///buffer for data the CPU rewrites between frames (instance attributes, lights, ui elements). Its storage is mapped persistently and coherently and split
+///into three regions. The first write of a frame moves to the next region, after waiting for the fence of the last frame that read it, so writes go straight
+///into memory the GPU is done with, without orphaning or driver copies. Several writes in one frame get consecutive ranges of the region
+///</summary>
+class EStreamBuffer
+{
+public:
+	static const int regionCount = 3;
+
+	///<summary>
+	///creates no GL objects, the storage is created by the first write
+	///</summary>
+	EStreamBuffer(GLenum target);
+	~EStreamBuffer();
+
+	///<summary>
+	///copies the data into the current region and binds that range to the binding point. An empty range unbinds the binding point
+	///</summary>
+	void Write(const void* data, GLsizeiptr size, GLuint binding);
+
+	///<summary>
+	///fences the regions read by the frame that was just submitted. Call once per frame after all draws
+	///</summary>
+	static void NextFrame();
+
+private:
+	// waits until the GPU finished the frame
+	static void waitForFrame(unsigned long long frame);
+	// creates storage with regions of at least the given size
+	void allocate(GLsizeiptr regionSize);
+
+	GLenum target;
+	GLuint buffer = 0;
+	char* mapped = nullptr;
+	GLsizeiptr regionSize = 0;
+	GLsizeiptr alignment = 1;
+	int region = 0;
+	// the region is bound from this write on, so every frame up to the next write reads it
+	GLsizeiptr writeOffset = 0;
+	unsigned long long writeFrame = 0;
+	unsigned long long lastRead[regionCount] = {};
+
+	static vector<EStreamBuffer*> instances;
+	static unsigned long long frame;
+	// fences of the submitted frames that may still be running, oldest first
+	static deque<pair<unsigned long long, GLsync>> frameFences;
+};
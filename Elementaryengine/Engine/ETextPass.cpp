@@ -18,131 +18,63 @@ ETextPass::~ETextPass()
 
 void ETextPass::Render()
 {
-	ERenderPass::Render();
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// the quads of all text elements
+	atlas.BeginFrame();
+	instances.clear();
 	for each (ETextElement* ete in Game::textElements)
 	{
-		RenderText(ete->text,ete->posX,ete->posY,ete->scale,ete->color);
+		BuildText(ete->text, ete->posX, ete->posY, ete->scale, ete->color);
+	}
+	if (instances.empty()) {
+		return;
 	}
+	glyphSSBO.Write(instances.data(), sizeof(GlyphInstance) * instances.size(), glyphBinding);
+
+	ERenderPass::Render();
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, atlas.Texture);
+	glBindVertexArray(VAO);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instances.size());
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void ETextPass::Initialize()
 {
 	_shader = new Shader("..\\shaders\\Text.vert", "..\\shaders\\Text.frag");
 	_shader->use();
-	textColor = EOGLUniform<vec3>(_shader, "textColor", vec3(1));
 	proj= EOGLUniform<mat4>(_shader, "projection", mat4(1));
 
 	ERenderPass::Initialize();
 
-
 	// load Font
-	if (FT_Init_FreeType(&ft))
-		std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
-
-	if (FT_New_Face(ft, path.c_str(), 0, &face))
-		std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
-
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Disable byte-alignment restriction
-
-	// use 48px bitmap
-	FT_Set_Pixel_Sizes(face, 0, 48);
+	atlas.Initialize(path, glyphPixelSize, atlasSize);
 
-	for (GLubyte c = 0; c < 128; c++)
-	{
-		// Load character glyph 
-		if (FT_Load_Char(face, c, FT_LOAD_RENDER))
-		{
-			std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
-			continue;
-		}
-		// Generate texture
-		GLuint texture;
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RED,
-			face->glyph->bitmap.width,
-			face->glyph->bitmap.rows,
-			0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			face->glyph->bitmap.buffer
-		);
-		// Set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		// Now store character for later use
-		Character character = {
-			texture,
-			glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-			glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-			face->glyph->advance.x
-		};
-		Characters.insert(std::pair<GLchar, Character>(c, character));
-	}
-	FT_Done_Face(face);
-	FT_Done_FreeType(ft);
 	projection = glm::ortho(0.0f, (float)displaySettings->windowWidth, 0.0f, (float)displaySettings->windowHeight);
 
 	proj.Update(projection);
-	// custom vertex array to prevent interference with EOpenGl::RenderQuad()
+	// custom vertex array to prevent interference with EOpenGl::RenderQuad(), the quads have no vertex attributes
 	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &VBO);
-	glBindVertexArray(VAO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	glBindVertexArray(0);
-
 }
 
-void ETextPass::RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, vec3 color)
+void ETextPass::BuildText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, vec3 color)
 {
-	// Activate corresponding render state	
-	textColor.Update(color);
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(VAO);
-
 	// Iterate through all characters
-	std::string::const_iterator c;
-	for (c = text.begin(); c != text.end(); c++)
+	size_t i = 0;
+	while (i < text.size())
 	{
-		Character ch = Characters[*c];
-
-		GLfloat xpos = x + ch.bearing.x * scale;
-		GLfloat ypos = y - (ch.size.y - ch.bearing.y) * scale;
-
-		GLfloat w = ch.size.x * scale;
-		GLfloat h = ch.size.y * scale;
-		// Update VBO for each character
-		GLfloat vertices[6][4] = {
-			{ xpos,     ypos + h,   0.0, 0.0 },
-		{ xpos,     ypos,       0.0, 1.0 },
-		{ xpos + w, ypos,       1.0, 1.0 },
-
-		{ xpos,     ypos + h,   0.0, 0.0 },
-		{ xpos + w, ypos,       1.0, 1.0 },
-		{ xpos + w, ypos + h,   1.0, 0.0 }
-		};
-		// Render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.textureID);
-		// Update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		// Render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-		// Now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-		x += (ch.advance >> 6) * scale; // Bitshift by 6 to get value in pixels (2^6 = 64)
+		Glyph ch = atlas.Get(EGlyphAtlas::DecodeUTF8(text, i));
+
+		// spaces and glyphs that didn't fit into the atlas only move the cursor
+		if (ch.size.x > 0 && ch.size.y > 0) {
+			GLfloat xpos = x + ch.bearing.x * scale;
+			GLfloat ypos = y - (ch.size.y - ch.bearing.y) * scale;
+			GlyphInstance instance = { vec4(xpos, ypos, vec2(ch.size) * scale), ch.uv, vec4(color, 1) };
+			instances.push_back(instance);
+		}
+		// Now advance cursors for next glyph
+		x += ch.advance * scale;
 	}
-	glBindVertexArray(0);
-	glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -1,7 +1,7 @@
 #pragma once
 #include "ERenderPass.h"
-#include <ft2build.h>
-#include FT_FREETYPE_H  
+#include <EGlyphAtlas.h>
+#include <EStreamBuffer.h>
 
 #include <map>
 #include <iterator>
@@ -10,14 +10,10 @@
 
 using namespace std;
 
-struct Character {
-	GLuint     textureID;  // ID handle of the glyph texture
-	glm::ivec2 size;       // Size of glyph
-	glm::ivec2 bearing;    // Offset from baseline to left/top of glyph
-	GLuint     advance;    // Offset to advance to next glyph
-};
-
-
+///<summary>
+///draws all text elements with one instanced draw. The text is decoded as UTF-8, every glyph becomes an instance with its screen rectangle,
+///its rectangle in the glyph atlas and its color, the vertex shader builds the quads from them
+///</summary>
 class ETextPass :
 	public ERenderPass
 {
@@ -27,17 +23,31 @@ public:
 	string path;
 	glm::mat4 projection;
 
-	map<GLchar, Character> Characters;
+	// glyphs are rasterized at this size in pixels into an atlas of atlasSize x atlasSize texels
+	static const unsigned int glyphPixelSize = 48;
+	static const unsigned int atlasSize = 1024;
+	// binding point of the glyph instances
+	static const int glyphBinding = 26;
 
 	virtual void Render();
 	virtual void Initialize();
 
 private:
-	FT_Library ft;
-	FT_Face face;
-	GLuint VAO, VBO;
+	// one quad of text, the layout of the instances in Text.vert
+	struct GlyphInstance
+	{
+		// corner and size on screen in pixels
+		vec4 rect;
+		// corner and size in the atlas
+		vec4 uv;
+		vec4 color;
+	};
+
+	EGlyphAtlas atlas;
+	vector<GlyphInstance> instances;
+	EStreamBuffer glyphSSBO{ GL_SHADER_STORAGE_BUFFER };
+	GLuint VAO;
 	EOGLUniform<mat4> proj;
-	EOGLUniform<vec3> textColor;
-	void RenderText(std::string text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color);
+	// adds the glyph quads of the text to the instances
+	void BuildText(const std::string& text, GLfloat x, GLfloat y, GLfloat scale, glm::vec3 color);
 };
-
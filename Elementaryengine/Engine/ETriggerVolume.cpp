@@ -0,0 +1,182 @@
+#include "ETriggerVolume.h"
+#include <Game.h>
+#include <algorithm>
+
+vector<ETriggerVolume*> ETriggerVolume::triggers;
+vector<ETriggerVolume::TriggerEvent> ETriggerVolume::events;
+mutex ETriggerVolume::triggersMutex;
+vector<ETriggerVolume*> ETriggerVolume::destroyedTriggers;
+
+ETriggerVolume::ETriggerVolume(vec3 position, vec3 halfExtents, int layerMask)
+	: ETriggerVolume(position, new btBoxShape(Game::toBullet(halfExtents)), layerMask)
+{
+}
+
+ETriggerVolume::ETriggerVolume(vec3 position, float radius, int layerMask)
+	: ETriggerVolume(position, new btSphereShape(radius), layerMask)
+{
+}
+
+ETriggerVolume::ETriggerVolume(vec3 position, btCollisionShape * shape, int layerMask)
+{
+	this->shape = shape;
+	ghost = new btPairCachingGhostObject();
+	ghost->setCollisionShape(shape);
+	ghost->setWorldTransform(btTransform(btQuaternion::getIdentity(), Game::toBullet(position)));
+	ghost->setCollisionFlags(ghost->getCollisionFlags() | btCollisionObject::CF_NO_CONTACT_RESPONSE);
+	// a ghost is never simulated, it has to stay active to keep its contacts updated
+	ghost->setActivationState(DISABLE_DEACTIVATION);
+	ghost->setUserPointer(this);
+	{
+		lock_guard<mutex> lock(triggersMutex);
+		triggers.push_back(this);
+	}
+	lock_guard<mutex> lock(Game::physicsMutex);
+	Game::dynamicsWorld->addCollisionObject(ghost, ECollisionLayers::Group(ECollisionLayers::triggerLayer), layerMask);
+}
+
+ETriggerVolume::~ETriggerVolume()
+{
+	delete ghost;
+	delete shape;
+}
+
+void ETriggerVolume::setPosition(vec3 position)
+{
+	lock_guard<mutex> lock(Game::physicsMutex);
+	btTransform transform = ghost->getWorldTransform();
+	transform.setOrigin(Game::toBullet(position));
+	ghost->setWorldTransform(transform);
+}
+
+vec3 ETriggerVolume::getPosition()
+{
+	return Game::toGlm(ghost->getWorldTransform().getOrigin());
+}
+
+const vector<Asset*>& ETriggerVolume::getOverlapping()
+{
+	return overlapping;
+}
+
+void ETriggerVolume::Destroy()
+{
+	if (destroyed)
+		return;
+	destroyed = true;
+	{
+		lock_guard<mutex> lock(triggersMutex);
+		triggers.erase(remove(triggers.begin(), triggers.end(), this), triggers.end());
+		events.erase(remove_if(events.begin(), events.end(), [this](const TriggerEvent& e) { return e.trigger == this; }), events.end());
+	}
+	{
+		lock_guard<mutex> lock(Game::physicsMutex);
+		Game::dynamicsWorld->removeCollisionObject(ghost);
+	}
+	destroyedTriggers.push_back(this);
+}
+
+static Asset* AssetOf(const btCollisionObject* object)
+{
+	if (btRigidBody::upcast(object) == nullptr)
+		return nullptr;
+	return static_cast<Asset*>(object->getUserPointer());
+}
+
+void ETriggerVolume::Step(btCollisionWorld * world)
+{
+	lock_guard<mutex> lock(triggersMutex);
+	btOverlappingPairCache* worldPairs = world->getPairCache();
+	btManifoldArray manifolds;
+	for each (ETriggerVolume* trigger in triggers)
+	{
+		// the ghost only knows the broadphase pairs, the narrowphase result is in the manifolds of the world's pairs
+		set<Asset*> now;
+		btBroadphasePairArray& pairs = trigger->ghost->getOverlappingPairCache()->getOverlappingPairArray();
+		for (int i = 0; i < pairs.size(); i++)
+		{
+			btBroadphasePair* pair = worldPairs->findPair(pairs[i].m_pProxy0, pairs[i].m_pProxy1);
+			if (pair == nullptr || pair->m_algorithm == nullptr)
+				continue;
+			manifolds.resize(0);
+			pair->m_algorithm->getAllContactManifolds(manifolds);
+			for (int m = 0; m < manifolds.size(); m++)
+			{
+				btPersistentManifold* manifold = manifolds[m];
+				const btCollisionObject* other = manifold->getBody0() == trigger->ghost ? manifold->getBody1() : manifold->getBody0();
+				Asset* asset = AssetOf(other);
+				if (asset == nullptr)
+					continue;
+				for (int p = 0; p < manifold->getNumContacts(); p++)
+				{
+					if (manifold->getContactPoint(p).getDistance() < 0) {
+						now.insert(asset);
+						break;
+					}
+				}
+			}
+		}
+
+		for each (Asset* asset in now)
+		{
+			if (trigger->inside.count(asset) == 0) {
+				events.push_back({ trigger, asset, true });
+			}
+		}
+		for each (Asset* asset in trigger->inside)
+		{
+			if (now.count(asset) == 0) {
+				events.push_back({ trigger, asset, false });
+			}
+		}
+		trigger->inside.swap(now);
+	}
+}
+
+void ETriggerVolume::Dispatch()
+{
+	vector<TriggerEvent> current;
+	{
+		lock_guard<mutex> lock(triggersMutex);
+		current.swap(events);
+	}
+	Game& game = Game::Instance();
+	for each (TriggerEvent e in current)
+	{
+		// destroyed by an earlier handler
+		if (e.trigger->destroyed)
+			continue;
+		if (e.entered) {
+			e.trigger->overlapping.push_back(e.asset);
+			e.trigger->OnEnter(e.trigger, e.asset);
+			if (game.gameMode != nullptr) {
+				game.gameMode->OnTriggerEnter(e.trigger, e.asset);
+			}
+		}
+		else {
+			e.trigger->overlapping.erase(remove(e.trigger->overlapping.begin(), e.trigger->overlapping.end(), e.asset), e.trigger->overlapping.end());
+			e.trigger->OnExit(e.trigger, e.asset);
+			if (game.gameMode != nullptr) {
+				game.gameMode->OnTriggerExit(e.trigger, e.asset);
+			}
+		}
+		game.eScriptContext->RunTriggerHandler(e.entered ? "OnTriggerEnter" : "OnTriggerExit", e.trigger, e.asset);
+	}
+
+	for each (ETriggerVolume* trigger in destroyedTriggers)
+	{
+		delete trigger;
+	}
+	destroyedTriggers.clear();
+}
+
+void ETriggerVolume::Forget(Asset * asset)
+{
+	lock_guard<mutex> lock(triggersMutex);
+	for each (ETriggerVolume* trigger in triggers)
+	{
+		trigger->inside.erase(asset);
+		trigger->overlapping.erase(remove(trigger->overlapping.begin(), trigger->overlapping.end(), asset), trigger->overlapping.end());
+	}
+	events.erase(remove_if(events.begin(), events.end(), [asset](const TriggerEvent& e) { return e.asset == asset; }), events.end());
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <EEngine.h>
+#include <ECollisionLayers.h>
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision\CollisionDispatch\btGhostObject.h>
+#include <mutex>
+#include <set>
+
+#define DllImport   __declspec( dllimport )
+#define DllExport   __declspec( dllexport )
+
+using namespace std;
+using namespace glm;
+
+class ETriggerVolume;
+static void defaultOnTrigger(ETriggerVolume* trigger, Asset* asset) {}
+
+///<summary>
+///persistent sphere or box area that reports assets entering and leaving it. It is a ghost object without contact response, so it only reads the contacts the physics step computes anyway
+///</summary>
+class DllExport ETriggerVolume
+{
+public:
+	///<summary>
+	///box trigger, only assets on the layers in layerMask are reported
+	///</summary>
+	ETriggerVolume(vec3 position, vec3 halfExtents, int layerMask = ECollisionLayers::allLayers);
+
+	///<summary>
+	///sphere trigger, only assets on the layers in layerMask are reported
+	///</summary>
+	ETriggerVolume(vec3 position, float radius, int layerMask = ECollisionLayers::allLayers);
+
+	void setPosition(vec3 position);
+	vec3 getPosition();
+
+	///<summary>
+	///assets inside the volume as of the last dispatch
+	///</summary>
+	const vector<Asset*>& getOverlapping();
+
+	///<summary>
+	///called on the game thread when an asset enters the volume
+	///</summary>
+	void (*OnEnter)(ETriggerVolume* trigger, Asset* asset) = &defaultOnTrigger;
+
+	///<summary>
+	///called on the game thread when an asset leaves the volume
+	///</summary>
+	void (*OnExit)(ETriggerVolume* trigger, Asset* asset) = &defaultOnTrigger;
+
+	///<summary>
+	///removes the volume from the world, it gets deleted after the next dispatch
+	///</summary>
+	void Destroy();
+
+	///<summary>
+	///compares the contacts of every volume with the last step, called by the physics step
+	///</summary>
+	static void Step(btCollisionWorld* world);
+
+	///<summary>
+	///delivers the enter and exit events to the volumes, the GameMode and the script functions OnTriggerEnter(trigger, asset) and OnTriggerExit(trigger, asset). Call on the game thread
+	///</summary>
+	static void Dispatch();
+
+	///<summary>
+	///removes the asset from all volumes without an exit event, call when it gets destroyed
+	///</summary>
+	static void Forget(Asset* asset);
+
+private:
+	ETriggerVolume(vec3 position, btCollisionShape* shape, int layerMask);
+	~ETriggerVolume();
+
+	struct TriggerEvent
+	{
+		ETriggerVolume* trigger;
+		Asset* asset;
+		bool entered;
+	};
+
+	btCollisionShape* shape;
+	btPairCachingGhostObject* ghost;
+	bool destroyed = false;
+
+	// physics thread
+	set<Asset*> inside;
+
+	// game thread
+	vector<Asset*> overlapping;
+
+	// all volumes and the events of the last steps, guarded by triggersMutex
+	static vector<ETriggerVolume*> triggers;
+	static vector<TriggerEvent> events;
+	static mutex triggersMutex;
+
+	// game thread, destroyed volumes wait here until no event can refer to them anymore
+	static vector<ETriggerVolume*> destroyedTriggers;
+};
@@ -0,0 +1,128 @@
+#include "EVolumetricPass.h"
+#include <Game.h>
+
+EVolumetricPass::EVolumetricPass(GLuint depthBuffer, GLuint colorBuffer)
+{
+	DepthBuffer = depthBuffer;
+	ColorBuffer = colorBuffer;
+}
+
+
+EVolumetricPass::~EVolumetricPass()
+{
+}
+
+void EVolumetricPass::Render()
+{
+	int scaledWidth = (std::max)(1, (int)(displaySettings->windowWidth * ResolutionScale));
+	int scaledHeight = (std::max)(1, (int)(displaySettings->windowHeight * ResolutionScale));
+	if (scaledWidth != width || scaledHeight != height) {
+		width = scaledWidth;
+		height = scaledHeight;
+		allocate();
+	}
+
+	// march the rays at the reduced resolution, the lamps and their clusters are still bound from the illumination pass
+	ERenderPass::Render();
+	uniformFrameIndex.Update(frameIndex);
+	glBindFramebuffer(GL_FRAMEBUFFER, renderBuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, current, 0);
+	glViewport(0, 0, width, height);
+	glDisable(GL_DEPTH_TEST);
+	glActiveTexture(GL_TEXTURE6);
+	glBindTexture(GL_TEXTURE_2D, DepthBuffer);
+	glActiveTexture(GL_TEXTURE8);
+	glBindTexture(GL_TEXTURE_2D, Game::eOpenGl->shadowMaps);
+	Game::eOpenGl->renderQuad();
+
+	// accumulate with the history of the last frames
+	int nextHistory = 1 - historyIndex;
+	resolveShader->use();
+	uniformResolveInvProj.Update(inverse(Game::Projection));
+	uniformResolveInvView.Update(inverse(Game::View));
+	uniformResolveProj.Update(Game::Projection);
+	uniformResolvePreviousView.Update(previousView);
+	uniformResolveHistoryValid.Update(historyValid);
+	uniformResolveBlend.Update(HistoryBlend);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history[nextHistory], 0);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, current);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, history[historyIndex]);
+	Game::eOpenGl->renderQuad();
+
+	// add the upsampled light to the lit frame
+	upsampleShader->use();
+	uniformUpsampleInvProj.Update(inverse(Game::Projection));
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ColorBuffer, 0);
+	glViewport(0, 0, displaySettings->windowWidth, displaySettings->windowHeight);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, history[nextHistory]);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE);
+	Game::eOpenGl->renderQuad();
+	glDisable(GL_BLEND);
+	glActiveTexture(GL_TEXTURE0);
+
+	historyIndex = nextHistory;
+	historyValid = true;
+	previousView = Game::View;
+	frameIndex++;
+}
+
+void EVolumetricPass::Initialize()
+{
+	// the march is the PBR shader with its own main, it shares the lamps and the shadow sampling with the illumination
+	_shader = new Shader("..\\shaders\\geometry.vert", "..\\shaders\\PBRShader.frag", string("#define volumetricMarch \n"));
+	_uniforms.push_back(new EOGLUniform<vec3>(_shader, "viewPos", []() {return Game::activeCam->position; }));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "gDepth", 6));
+	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "invProj", []() {return inverse(Game::Projection); }));
+	_uniforms.push_back(new EOGLUniform<mat4>(_shader, "invView", []() {return inverse(Game::View); }));
+	_uniforms.push_back(new EOGLUniform<float>(_shader, "far_plane", 25.0f));
+	_uniforms.push_back(new EOGLUniform<int>(_shader, "shadowMaps", 8));
+	uniformFrameIndex = EOGLUniform<int>(_shader, "frameIndex", 0);
+
+	resolveShader = new Shader("..\\shaders\\geometry.vert", "..\\shaders\\VolumetricResolve.frag");
+	resolveShader->use();
+	resolveShader->setInt("current", 0);
+	resolveShader->setInt("history", 1);
+	uniformResolveInvProj = EOGLUniform<mat4>(resolveShader, "invProj", mat4(1));
+	uniformResolveInvView = EOGLUniform<mat4>(resolveShader, "invView", mat4(1));
+	uniformResolveProj = EOGLUniform<mat4>(resolveShader, "proj", mat4(1));
+	uniformResolvePreviousView = EOGLUniform<mat4>(resolveShader, "previousView", mat4(1));
+	uniformResolveHistoryValid = EOGLUniform<bool>(resolveShader, "historyValid", false);
+	uniformResolveBlend = EOGLUniform<float>(resolveShader, "blend", HistoryBlend);
+
+	upsampleShader = new Shader("..\\shaders\\geometry.vert", "..\\shaders\\VolumetricUpsample.frag");
+	upsampleShader->use();
+	upsampleShader->setInt("volumetrics", 0);
+	upsampleShader->setInt("gDepth", 6);
+	uniformUpsampleInvProj = EOGLUniform<mat4>(upsampleShader, "invProj", mat4(1));
+
+	ERenderPass::Initialize();
+}
+
+void EVolumetricPass::allocate()
+{
+	glDeleteTextures(1, &current);
+	glDeleteTextures(2, history);
+	current = createTexture();
+	history[0] = createTexture();
+	history[1] = createTexture();
+	historyValid = false;
+}
+
+GLuint EVolumetricPass::createTexture()
+{
+	// rgb = light, a = view depth of the end of the ray for the reprojection and the upsampling
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	return texture;
+}
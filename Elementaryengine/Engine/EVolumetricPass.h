@@ -0,0 +1,52 @@
+#pragma once
+#include "ERenderPass.h"
+
+///<summary>
+///renders the volumetric light of the lamps in its own pass at a reduced resolution. Every pixel marches its view ray with few samples at an offset
+///that changes between neighbouring pixels and frames, the result is accumulated over the frames at the reprojected position of the pixel
+///and upsampled to the full resolution along the depth edges, added to the lit frame
+///</summary>
+class EVolumetricPass :
+	public ERenderPass
+{
+public:
+	EVolumetricPass(GLuint depthBuffer, GLuint colorBuffer);
+	~EVolumetricPass();
+
+	virtual void Render();
+	virtual void Initialize();
+
+	GLuint DepthBuffer;
+	// the output of the illumination pass the light is added to
+	GLuint ColorBuffer;
+	// size of the pass relative to the window
+	float ResolutionScale = 0.5f;
+	// the part of a new frame in the accumulated light
+	float HistoryBlend = 0.1f;
+
+private:
+	// (re)creates the textures at the scaled window size, the history is invalid after that
+	void allocate();
+	GLuint createTexture();
+
+	Shader* resolveShader;
+	Shader* upsampleShader;
+	EOGLUniform<int> uniformFrameIndex;
+	EOGLUniform<mat4> uniformResolveInvProj;
+	EOGLUniform<mat4> uniformResolveInvView;
+	EOGLUniform<mat4> uniformResolveProj;
+	EOGLUniform<mat4> uniformResolvePreviousView;
+	EOGLUniform<bool> uniformResolveHistoryValid;
+	EOGLUniform<float> uniformResolveBlend;
+	EOGLUniform<mat4> uniformUpsampleInvProj;
+
+	// the light marched this frame and two histories, one is read while the other is written
+	GLuint current = 0;
+	GLuint history[2] = { 0, 0 };
+	int historyIndex = 0;
+	bool historyValid = false;
+	int width = 0;
+	int height = 0;
+	int frameIndex = 0;
+	mat4 previousView;
+};
@@ -58,6 +58,8 @@ vector<ETextElement*> Game::textElements;
 Camera* Game::activeCam;
 btDiscreteDynamicsWorld* Game::dynamicsWorld;
 bool Game::simulatePhysics = true;
+mutex Game::physicsMutex;
+atomic<double> Game::fixedTimeStep(0);
 double Game::physicsFps;
 EOpenGl* Game::eOpenGl = new EOpenGl();
 bool Game::meshChanged = true;
@@ -74,6 +76,8 @@ double Game::smoothFps;
 mat4 Game::View;
 mat4 Game::Projection;
 EDisplaySettings* Game::displaySettings = new EDisplaySettings();
+EPhysicsSettings* Game::physicsSettings = new EPhysicsSettings();
+string Game::physicsBakeFile = "";
 EConsole Game::console = EConsole();
 // start the game and run the main loop
 void Game::Start()
@@ -85,13 +89,10 @@ void Game::Start()
 	eScriptContext = new EScriptContext();
 
 	//Setup Bullet physics
-	btBroadphaseInterface* broadphase = new btDbvtBroadphase();
-	btDefaultCollisionConfiguration* collisionConfiguration = new btDefaultCollisionConfiguration();
-	btCollisionDispatcher* dispatcher = new btCollisionDispatcher(collisionConfiguration);
-	btGImpactCollisionAlgorithm::registerAlgorithm(dispatcher);
-	btSequentialImpulseConstraintSolver* solver = new btSequentialImpulseConstraintSolver;
-	dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
-	dynamicsWorld->setGravity(btVector3(0, -9.8, 0));
+	dynamicsWorld = EPhysicsWorld::Create(*physicsSettings);
+	ECollisionEvents::Setup(dynamicsWorld);
+	EContinuousCollision::Setup(dynamicsWorld);
+	EJobSystem::Start();
 	
 
 	system("cls");
@@ -106,8 +107,15 @@ void Game::Start()
 
 	gameMode->window = eOpenGl->window;
 
+	if (!physicsBakeFile.empty()) {
+		EPhysicsBake::Load(physicsBakeFile);
+	}
 	LoadScene();
 	eScriptContext->ReadScript(L"main.js");
+	// a missing or outdated bake gets written from the scene that was just built
+	if (!physicsBakeFile.empty() && !EPhysicsBake::Finish()) {
+		EPhysicsBake::Bake(physicsBakeFile);
+	}
 
 	float viewaspect = (float)displaySettings->windowWidth / (float)displaySettings->windowHeight;
 	Projection = glm::perspective(glm::radians(60.0f), viewaspect, 0.1f, 100.0f);
@@ -120,8 +128,10 @@ void Game::Start()
 
 	loop();
 
+	EJobSystem::Stop();
+
 	// cleanup physics
-	delete dynamicsWorld;
+	EPhysicsWorld::Destroy(dynamicsWorld);
 
 	// Close OpenGL window and terminate GLFW
 	eOpenGl->CleanUp();
@@ -172,6 +182,13 @@ void Game::loop()
 		}
 		View = activeCam->GetView();
 
+		// apply the transforms of the bodies and the soft body vertices that moved during the last physics steps
+		EMotionState::SyncChangedAssets();
+		ESoftBody::SyncChanged();
+		// deliver the contacts of the last physics steps
+		ECollisionEvents::Dispatch();
+		ETriggerVolume::Dispatch();
+
 		if (gameMode != nullptr) {
 			gameMode->Tick(deltaTime);
 		}
@@ -187,6 +204,7 @@ void Game::loop()
 		for each (Asset* a in assetsToDelete)
 		{
 			nextAssets.erase(std::remove(Game::nextAssets.begin(), Game::nextAssets.end(), a), Game::nextAssets.end());
+			ECollisionEvents::DropEvents(a);
 			Asset::rendererAssetChangedCallback(a);
 			delete a;
 		}
@@ -238,6 +256,8 @@ void Game::Render()
 	renderer->SetupFrame(meshChanged, eOpenGl);
 	renderer->RenderFrame(eOpenGl, displaySettings, View, Projection);
 	renderer->RenderFX(eOpenGl,displaySettings);
+	// the streamed buffers written this frame must not be overwritten until the GPU is done with it
+	EStreamBuffer::NextFrame();
 
 	meshChanged = false;
 }
@@ -263,22 +283,32 @@ void Game::LoadScene()
 	}
 }
 
-RayCastHit Game::Raycast(vec3 Start, vec3 End)
+// rays pass through trigger volumes
+struct BodyRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+{
+	BodyRayResultCallback(const btVector3& from, const btVector3& to) : ClosestRayResultCallback(from, to) {}
+
+	virtual bool needsCollision(btBroadphaseProxy* proxy0) const
+	{
+		return ClosestRayResultCallback::needsCollision(proxy0) && btRigidBody::upcast(static_cast<btCollisionObject*>(proxy0->m_clientObject)) != nullptr;
+	}
+};
+
+RayCastHit Game::Raycast(vec3 Start, vec3 End, int layerMask)
 {
 	RayCastHit r;
-	btCollisionWorld::ClosestRayResultCallback RayCallback(toBullet(Start), toBullet(End));
+	BodyRayResultCallback RayCallback(toBullet(Start), toBullet(End));
+	// bodies on other layers get rejected by the broadphase
+	RayCallback.m_collisionFilterGroup = btBroadphaseProxy::AllFilter;
+	RayCallback.m_collisionFilterMask = layerMask;
+	lock_guard<mutex> lock(physicsMutex);
 	//Perform raycast
-	RayCallback.m_hitNormalWorld;
 	dynamicsWorld->rayTest(toBullet(Start), toBullet(End), RayCallback);
 	if (RayCallback.hasHit()) {
 		r.hitPos = toGlm(RayCallback.m_hitPointWorld);
 		r.hitNormal = toGlm(RayCallback.m_hitNormalWorld);
-		for each (Asset* a in assets)
-		{
-			if (a->getRigidBody() == RayCallback.m_collisionObject) {
-				r.hitAsset = a;
-				break;
-			}
+		if (btRigidBody::upcast(RayCallback.m_collisionObject) != nullptr) {
+			r.hitAsset = static_cast<Asset*>(RayCallback.m_collisionObject->getUserPointer());
 		}
 	}
 	return r;
@@ -316,6 +346,7 @@ DWORD WINAPI PhysicsThread(LPVOID lpParam)
 	double oTime = 0;
 	double cTime = 0;
 	double dTime = 0;
+	double fixedTimeLeft = 0;
 
 	while (!Game::shouldClose)
 	{
@@ -323,7 +354,24 @@ DWORD WINAPI PhysicsThread(LPVOID lpParam)
 		cTime = glfwGetTime();
 		dTime = cTime - oTime;
 		if (Game::simulatePhysics) {
-			Game::dynamicsWorld->stepSimulation(dTime, 1);
+			lock_guard<mutex> lock(Game::physicsMutex);
+			// read once, a script may change it meanwhile
+			double fixedTimeStep = Game::fixedTimeStep;
+			if (fixedTimeStep > 0) {
+				// whole steps only, never more than 4 at once so a stall does not snowball
+				fixedTimeLeft += dTime;
+				if (fixedTimeLeft > 4 * fixedTimeStep) {
+					fixedTimeLeft = 4 * fixedTimeStep;
+				}
+				while (fixedTimeLeft >= fixedTimeStep)
+				{
+					Game::dynamicsWorld->stepSimulation(fixedTimeStep, 0);
+					fixedTimeLeft -= fixedTimeStep;
+				}
+			}
+			else {
+				Game::dynamicsWorld->stepSimulation(dTime, 1);
+			}
 		}
 		else {
 			Sleep(100);
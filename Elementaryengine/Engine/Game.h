@@ -12,10 +12,22 @@
 #include <windows.h>
 #include <UIElement.h>
 #include <memory>
+#include <mutex>
+#include <atomic>
 #include <EScriptContext.h>
 #include <RayCastHit.h>
 #include <ETextElement.h>
 #include <EConsole.h>
+#include <ECollisionEvents.h>
+#include <ETriggerVolume.h>
+#include <EPhysicsQueries.h>
+#include <EJobSystem.h>
+#include <EPhysicsSnapshot.h>
+#include <EContinuousCollision.h>
+#include <EPhysicsWorld.h>
+#include <EPhysicsBenchmark.h>
+#include <EPhysicsBake.h>
+#include <ESoftBody.h>
 
 class GameMode;
 #include <GameMode.h>
@@ -42,6 +54,15 @@ public:
 	static EOpenGl* eOpenGl;
 
 	static EDisplaySettings* displaySettings;
+
+	///<summary>
+	///Settings of the physics world. Permanent after Start() is called
+	///</summary> 
+	static EPhysicsSettings* physicsSettings;
+	///<summary>
+	///.bullet file the bodies of the scene and their collision shapes get baked to and loaded from on the next start, empty to always build them
+	///</summary> 
+	static string physicsBakeFile;
 	///<summary>
 	///The Gamemode to load
 	///</summary> 
@@ -219,7 +240,21 @@ public:
 	static btDiscreteDynamicsWorld* dynamicsWorld;
 	static bool simulatePhysics;
 
-	RayCastHit Raycast(vec3 Start, vec3 End);
+	///<summary>
+	///held by the physics thread while it steps, lock it to change the world from the game thread
+	///</summary> 
+	static mutex physicsMutex;
+
+	///<summary>
+	///0 (default) steps once per physics loop with the elapsed time. Otherwise only whole steps of this length are simulated, which makes the simulation repeatable (see EPhysicsSnapshot).
+	///Scripts set it on the game thread while the physics thread reads it
+	///</summary> 
+	static atomic<double> fixedTimeStep;
+
+	///<summary>
+	///Closest hit between the two points. Only assets on the layers in layerMask are hit
+	///</summary> 
+	RayCastHit Raycast(vec3 Start, vec3 End, int layerMask = ECollisionLayers::allLayers);
 
 
 
@@ -36,5 +36,20 @@ public:
 	///</summary> 
 	virtual void Stop() = 0;
 
+	///<summary>
+	///Called once per frame with all collision events of subscribed assets since the last frame.
+	///</summary> 
+	virtual void OnCollision(const vector<ECollisionEvent>& events) {};
+
+	///<summary>
+	///Called when an asset enters a trigger volume.
+	///</summary> 
+	virtual void OnTriggerEnter(ETriggerVolume* trigger, Asset* asset) {};
+
+	///<summary>
+	///Called when an asset leaves a trigger volume.
+	///</summary> 
+	virtual void OnTriggerExit(ETriggerVolume* trigger, Asset* asset) {};
+
 
 };
\ No newline at end of file
@@ -31,6 +31,35 @@ void Lamp::Render(mat4 view, mat4 projection)
 
 }
 
+void Lamp::setSpotAngle(float angle)
+{
+	spotAngle = clamp(angle, 1.0f, 89.0f);
+}
+
+float Lamp::getSpotAngle()
+{
+	// the field can also be written directly
+	return clamp(spotAngle, 1.0f, 89.0f);
+}
+
+void Lamp::setRadius(float range)
+{
+	radius = (std::max)(range, 0.01f);
+}
+
+float Lamp::getRadius()
+{
+	return radius;
+}
+
+vec4 Lamp::getCone()
+{
+	if (type == spotLamp) {
+		return vec4(normalize(Direction), cos(radians(getSpotAngle())));
+	}
+	return vec4(0, 0, 0, -1);
+}
+
 void Lamp::SetupLampComp()
 {
 	unsigned int dMFBO;
@@ -6,6 +6,10 @@
 #include <Model.h>
 #define DllImport   __declspec( dllimport )
 #define DllExport   __declspec( dllexport )
+
+// point lamps light in every direction and need a cube of shadows, spot lamps light a cone along their Direction and need one shadow map
+enum LampType { pointLamp, spotLamp };
+
 class Lamp :
 	public AssetComponent
 {
@@ -16,10 +20,37 @@ public:
 	Model* model;
 	DllExport static void SetupLampComp();
 	vec3 color;
-	vec3 Direction;
+	// the axis of the cone of spot lamps
+	vec3 Direction = vec3(0, -1, 0);
+	LampType type = pointLamp;
+	// half the opening angle of the cone of spot lamps in degrees, read it with getSpotAngle
+	float spotAngle = 45.0f;
+	///<summary>
+	///sets half the opening angle of the cone in degrees, clamped to 1 - 89. At 90 and above the cone and its shadow projection degenerate
+	///</summary>
+	DllExport void setSpotAngle(float angle);
+	///<summary>
+	///half the opening angle of the cone in degrees, clamped like setSpotAngle
+	///</summary>
+	DllExport float getSpotAngle();
+	// distance at which the light has faded out, the lamp lights nothing beyond it
+	float radius = 25.0f;
+	///<summary>
+	///sets the distance at which the light has faded out, at least 0.01 because the falloff divides by it
+	///</summary>
+	DllExport void setRadius(float range);
+	DllExport float getRadius();
 	static unsigned int depthMapFBO;
 	Texture* depthmap;
 	static const unsigned int SHADOW_WIDTH, SHADOW_HEIGHT;
 	bool throwShadows;
+	///<summary>
+	///the axis and the cosine of the half angle of the cone, point lamps are a cone of 180 degrees (cosine -1)
+	///</summary>
+	DllExport vec4 getCone();
+	// where the shadow map was last rendered from and if it has to be rendered again
+	vec3 shadowPosition;
+	vec4 shadowDirection;
+	bool shadowDirty = true;
 };
 
@@ -49,6 +49,9 @@ Mesh::Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture
 Mesh::~Mesh()
 {
 	Game::meshChanged = true;
+	if (!Game::isServer) {
+		Game::eOpenGl->geometryPool.Remove(this);
+	}
 	// Cleanup VBO
 	glDeleteBuffers(1, &vertexbuffer);
 	glDeleteVertexArrays(1, &VertexArrayID);
@@ -103,6 +106,29 @@ void Mesh::SetupMesh()
 	/**/
 }
 
+void Mesh::CalculateBounds()
+{
+	if (vertices.empty()) {
+		bounds = vec4(0, 0, 0, -1);
+		return;
+	}
+	// the sphere around the bounding box
+	vec3 low = vertices[0].Position;
+	vec3 high = vertices[0].Position;
+	for each (Vertex v in vertices)
+	{
+		low = (glm::min)(low, v.Position);
+		high = (glm::max)(high, v.Position);
+	}
+	vec3 center = (low + high) * 0.5f;
+	float radius = 0;
+	for each (Vertex v in vertices)
+	{
+		radius = (std::max)(radius, distance(center, v.Position));
+	}
+	bounds = vec4(center, radius);
+}
+
 mat4 Mesh::Model()
 {
 	mat4 model = mat4(1.0f);
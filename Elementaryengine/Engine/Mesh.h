@@ -28,6 +28,23 @@ public:
 	~Mesh();
 
 	Material* material;
+
+	// vertices that change every frame (soft bodies)
+	bool dynamicVertices = false;
+	// set when the vertices changed since the last upload, the renderer uploads only the range of this mesh
+	bool verticesChanged = false;
+	// first vertex and first index of the mesh in the renderer's geometry pool
+	int vertexOffset = 0;
+	int indexOffset = 0;
+	// size of the ranges the mesh has in the geometry pool, 0 if it has none yet
+	int poolVertexCount = 0;
+	int poolIndexCount = 0;
+	// bounding sphere of the vertices, xyz = center, w = radius. Meshes with a negative radius are never culled
+	vec4 bounds = vec4(0, 0, 0, -1);
+	///<summary>
+	///calculates the bounding sphere of the vertices
+	///</summary>
+	void CalculateBounds();
 	GLuint VertexArrayID;
 	GLuint vertexbuffer;
 
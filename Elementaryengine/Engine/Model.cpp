@@ -1,6 +1,7 @@
 #include "Model.h"
 #include <soil.h>
 #include <iostream>
+#include <EPhysicsBake.h>
 
 Model::Model()
 {
@@ -16,6 +17,49 @@ Model::Model(char * path)
 	loadModel(path);
 }
 
+Model::Model(char * path, EConvexDecompositionSettings collisionSettings)
+{
+	this->collisionSettings = collisionSettings;
+	loadModel(path);
+	// a loaded physics bake already has the compounds of the scene
+	if (!EPhysicsBake::Loaded())
+		buildCollision();
+}
+
+btCompoundShape * Model::getCollisionShape(vec3 scale)
+{
+	// the hulls get baked to the scale, so assets of the same size share one compound
+	for each (auto s in collisionShapes)
+	{
+		if (s.first == scale)
+			return s.second;
+	}
+
+	if (!collisionBuilt)
+		buildCollision();
+	if (collisionHulls.empty())
+		return nullptr;
+	btCompoundShape* shape = EConvexDecomposition::BuildCompound(collisionHulls, btVector3(scale.x, scale.y, scale.z), collisionSettings.margin);
+	collisionShapes.push_back(make_pair(scale, shape));
+	return shape;
+}
+
+void Model::addCollisionShape(vec3 scale, btCompoundShape * shape)
+{
+	for each (auto s in collisionShapes)
+	{
+		if (s.first == scale)
+			return;
+	}
+	collisionShapes.push_back(make_pair(scale, shape));
+}
+
+void Model::buildCollision()
+{
+	collisionHulls = EConvexDecomposition::Decompose(meshes, collisionSettings);
+	collisionBuilt = true;
+}
+
 
 
 void Model::loadModel(string path)
@@ -123,6 +167,7 @@ Mesh* Model::processMesh(aiMesh * mesh, const aiScene * scene)
 		texturesout.push_back(&t);
 	}
 	Mesh* m = new Mesh(vertices, indices, texturesout);
+	m->CalculateBounds();
 	if(mesh->mMaterialIndex >= 0)
 		m->material = materials[mesh->mMaterialIndex];
 
@@ -7,6 +7,7 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <Texture.h>
+#include <EConvexDecomposition.h>
 #define DllImport   __declspec( dllimport )
 #define DllExport   __declspec( dllexport )
 
@@ -18,9 +19,27 @@ public:
 	Model();
 	~Model();
 	Model(char *path);
+	///<summary>
+	///loads the model and runs the convex decomposition for its collision at import time
+	///</summary>
+	Model(char *path, EConvexDecompositionSettings collisionSettings);
 	vector<Mesh*> meshes;
 	vector<Material*> materials;
 
+	///<summary>
+	///the convex decomposition of the model as compound of hulls, scaled for an asset of the given size. decomposes the model on first use
+	///</summary>
+	///<returns>
+	///a compound shared by all assets with the same scale, nullptr if the model has no geometry
+	///</returns>
+	btCompoundShape* getCollisionShape(vec3 scale);
+
+	///<summary>
+	///shares a compound that was built elsewhere (a physics bake) with the assets of that scale
+	///</summary>
+	void addCollisionShape(vec3 scale, btCompoundShape* shape);
+	EConvexDecompositionSettings collisionSettings;
+
 private:
 	/*  Model Data  */
 	string directory;
@@ -29,5 +48,10 @@ private:
 	void processNode(aiNode *node, const aiScene *scene);
 	Mesh* processMesh(aiMesh *mesh, const aiScene *scene);
 	vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName);
+	void buildCollision();
+
+	bool collisionBuilt = false;
+	vector<vector<btVector3>> collisionHulls;
+	vector<pair<vec3, btCompoundShape*>> collisionShapes;
 };
 
@@ -10,7 +10,7 @@ using namespace glm;
 ///You can not create more than one instance of this class;
 ///</summary> 
 struct DllExport RayCastHit {
-	Asset* hitAsset;
+	Asset* hitAsset = nullptr;
 	vec3 hitPos;
 	vec3 hitNormal;
 };
\ No newline at end of file
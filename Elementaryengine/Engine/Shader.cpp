@@ -18,7 +18,7 @@ using namespace std;
 
 string Shader::defines;
 
-Shader::Shader(const GLchar * vertexPath, const GLchar * fragmentPath)
+Shader::Shader(const GLchar * vertexPath, const GLchar * fragmentPath, const string& shaderDefines)
 {
 	// 1. retrieve the vertex/fragment source code from filePath
 	std::string vertexCode;
@@ -50,8 +50,8 @@ Shader::Shader(const GLchar * vertexPath, const GLchar * fragmentPath)
 	}
 	string veCode = "";
 	string frCode = "";
-	veCode.append(defines).append(vertexCode);
-	frCode.append(defines).append(fragmentCode);
+	veCode.append(defines).append(shaderDefines).append(vertexCode);
+	frCode.append(defines).append(shaderDefines).append(fragmentCode);
 
 	const char* vShaderCode = veCode.c_str();
 	const char * fShaderCode = frCode.c_str();
@@ -188,7 +188,10 @@ Shader::Shader(const GLchar * computePath)
 	{
 		std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
 	}
-	const char * shaderCode = code.c_str();
+	string coCode = "";
+	coCode.append(defines).append(code);
+
+	const char * shaderCode = coCode.c_str();
 	// 2. compile shaders
 	unsigned int compute;
 	// vertex shader
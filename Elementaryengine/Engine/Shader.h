@@ -15,8 +15,8 @@ public:
 	// the program ID
 	unsigned int ID;
 	static string defines;
-	// constructor reads and builds the shader
-	Shader(const GLchar* vertexPath, const GLchar* fragmentPath);
+	// constructor reads and builds the shader, shaderDefines are added behind the defines of the renderer to compile variants of the same source
+	Shader(const GLchar* vertexPath, const GLchar* fragmentPath, const string& shaderDefines = "");
 	Shader(const GLchar* vertexPath, const GLchar* geompath, const GLchar* fragmentPath);
 	Shader(const GLchar* computePath);
 
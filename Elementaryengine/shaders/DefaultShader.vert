@@ -28,10 +28,21 @@ layout(std430, binding = 6) buffer didoff
 {
     int offsets[];
 };
+#ifdef gpuCulling
+// ids of the visible instances, the culled commands start at their base instance
+layout(std430, binding = 10) buffer Visible 
+{
+    uint visible[];
+};
+#endif
 
 void main()
 {
+#ifdef gpuCulling
+	int drawid = int(visible[gl_BaseInstance + gl_InstanceID]);
+#else
 	int drawid = gl_DrawID + offsets[gl_DrawID] + gl_InstanceID;
+#endif
     TexCoord = aTexCoord; 
 	FragPos = vec3(atrib[drawid].Model * atrib[drawid].Rot * vec4(aPos, 1.0));
     gl_Position = VP * atrib[drawid].Model * atrib[drawid].Rot * vec4(aPos, 1.0);
@@ -3,6 +3,8 @@ layout (location = 0) out vec4 FragCol;
 
 uniform vec3 lightPos;
 uniform float far_plane;
+// the cascades of the sun keep the depth of their orthographic projection
+uniform bool directional;
 
 void main()
 {
@@ -14,6 +16,6 @@ void main()
     
     // write this as modified depth
     //gl_FragDepth = lightDistance;
-    gl_FragDepth = lightDistance;
+    gl_FragDepth = directional ? gl_FragCoord.z : lightDistance;
     FragCol = vec4(lightDistance);
 }  
\ No newline at end of file
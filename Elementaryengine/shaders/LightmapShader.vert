@@ -22,10 +22,24 @@ layout(std430, binding = 6) buffer didoff
 {
     int offsets[];
 };
+#ifdef gpuCulling
+// the casters of the lamp, instance id in the low 24 bits and the cube faces it is in in the high bits
+layout(std430, binding = 14) buffer ShadowVisible 
+{
+    uint shadowVisible[];
+};
+out uint faces;
+#endif
 
 void main()
 {
+#ifdef gpuCulling
+    uint caster = shadowVisible[gl_BaseInstance + gl_InstanceID];
+    int drawid = int(caster & 0xFFFFFFu);
+    faces = caster >> 24;
+#else
     int drawid = gl_DrawID + offsets[gl_DrawID] + gl_InstanceID;
+#endif
 
     gl_Position = atrib[drawid].Model * vec4(aPos, 1.0);
 }  
\ No newline at end of file
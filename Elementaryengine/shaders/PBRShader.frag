@@ -7,7 +7,11 @@ uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 uniform sampler2D gMaterial;
 uniform sampler2D gDepth;
+#ifdef shadowAtlas
+uniform sampler2DShadow shadowMaps;
+#else
 uniform samplerCubeArrayShadow shadowMaps;
+#endif
 uniform	sampler2D colorCorrection;
 
 uniform vec3 directionalLightDirection; 
@@ -22,12 +26,123 @@ layout(std430, binding = 3) buffer lightColors
 {
     vec3 LightColors[];
 };
+// position and range of every lamp
 layout(std430, binding = 4) buffer lightPositions 
 {
-    vec3 LightPositions[];
+    vec4 LightPositions[];
+};
+// axis and cosine of the half angle of the cone of every lamp, -1 for point lamps
+layout(std430, binding = 19) buffer lightDirections 
+{
+    vec4 LightDirections[];
 };
 const float PI = 3.14159265359;
 
+#ifdef clusteredLighting
+// offset and count of the lamps of every cluster in LightIndices, built by LightCull.comp
+layout(std430, binding = 21) buffer clusters 
+{
+    uvec2 Clusters[];
+};
+layout(std430, binding = 22) buffer lightIndices 
+{
+    uint LightIndices[];
+};
+
+// the cluster of the pixel, the slices grow exponentially with the view depth like in LightCull.comp
+uvec2 clusterLights(vec3 fragPos)
+{
+	float depth = dot(fragPos - viewPos, -invView[2].xyz);
+	uint slice = uint(clamp(floor(log(max(depth, near) / near) / log(far / near) * clusterZ), 0, clusterZ - 1));
+	uvec2 tile = min(uvec2(TexCoord * vec2(clusterX, clusterY)), uvec2(clusterX - 1, clusterY - 1));
+	return Clusters[tile.x + tile.y * clusterX + slice * clusterX * clusterY];
+}
+#endif
+
+#ifdef shadowAtlas
+// the six tiles of every lamp in the atlas, xy = corner, z = size, all zero if the lamp has no shadow
+layout(std430, binding = 18) buffer shadowTiles 
+{
+    vec4 ShadowTiles[];
+};
+
+// the axes of the views the faces are rendered with: right, up and forward
+const vec3 faceRight[6] = vec3[](vec3(0, 0, -1), vec3(0, 0, 1), vec3(1, 0, 0), vec3(1, 0, 0), vec3(1, 0, 0), vec3(-1, 0, 0));
+const vec3 faceUp[6] = vec3[](vec3(0, -1, 0), vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1), vec3(0, -1, 0), vec3(0, -1, 0));
+const vec3 faceForward[6] = vec3[](vec3(1, 0, 0), vec3(-1, 0, 0), vec3(0, 1, 0), vec3(0, -1, 0), vec3(0, 0, 1), vec3(0, 0, -1));
+
+// the cascades of the sun, empty if it throws no shadows
+struct SunCascade{
+	mat4 matrix;
+	// xy = corner, z = size of the tile, w = depth bias
+	vec4 tile;
+	// the sphere around the part of the view the cascade covers
+	vec4 sphere;
+};
+layout(std430, binding = 20) buffer sunCascades 
+{
+    SunCascade SunCascades[];
+};
+
+// compares depth with the atlas at uv in the tile
+float sampleTile(vec4 tile, vec2 uv, float depth)
+{
+	// stay half a texel inside the tile so the filter doesn't read the neighbours
+	float halfTexel = 0.5 / textureSize(shadowMaps, 0).x;
+	uv = clamp(tile.xy + uv * tile.z, tile.xy + halfTexel, tile.xy + tile.z - halfTexel);
+	return texture(shadowMaps, vec3(uv, depth));
+}
+
+// 1 if the point is lit by the sun, from the first cascade that contains it
+float sunShadow(vec3 fragPos)
+{
+	for(int i = 0; i < SunCascades.length(); i++){
+		if(distance(fragPos, SunCascades[i].sphere.xyz) < SunCascades[i].sphere.w){
+			vec3 p = (SunCascades[i].matrix * vec4(fragPos, 1)).xyz * 0.5 + 0.5;
+			return sampleTile(SunCascades[i].tile, p.xy, p.z - SunCascades[i].tile.w);
+		}
+	}
+	return 1;
+}
+#endif
+
+// 1 if the point at fragToLight from the lamp is lit, depth is its distance divided by the far plane
+float sampleShadow(vec3 fragToLight, float depth, int index)
+{
+#ifdef shadowAtlas
+	// lamps without tiles are not in view, or throw no shadows. Their light still ends at the far plane
+	if(ShadowTiles[index * 6].z == 0){
+		return depth < 1 ? 1 : 0;
+	}
+
+	// spot lamps have one tile, rendered along the axis of the cone
+	vec4 cone = LightDirections[index];
+	if(cone.w > -1){
+		float forward = dot(cone.xyz, fragToLight);
+		if(forward <= 0){
+			return 0;
+		}
+		vec3 up = abs(cone.y) > 0.99 ? vec3(1, 0, 0) : vec3(0, 1, 0);
+		vec3 right = normalize(cross(cone.xyz, up));
+		up = cross(right, cone.xyz);
+		float tanHalfAngle = sqrt(1 - cone.w * cone.w) / cone.w;
+		vec2 ndc = vec2(dot(right, fragToLight), dot(up, fragToLight)) / (forward * tanHalfAngle);
+		if(abs(ndc.x) > 1 || abs(ndc.y) > 1){
+			return 0;
+		}
+		return sampleTile(ShadowTiles[index * 6], ndc * 0.5 + 0.5, depth);
+	}
+
+	// point lamps: the face is the major axis of the direction
+	vec3 a = abs(fragToLight);
+	int face = a.x >= a.y && a.x >= a.z ? (fragToLight.x > 0 ? 0 : 1) : (a.y >= a.z ? (fragToLight.y > 0 ? 2 : 3) : (fragToLight.z > 0 ? 4 : 5));
+	vec2 uv = vec2(dot(faceRight[face], fragToLight), dot(faceUp[face], fragToLight)) / dot(faceForward[face], fragToLight) * 0.5 + 0.5;
+	return sampleTile(ShadowTiles[index * 6 + face], uv, depth);
+#else
+	return texture(shadowMaps, vec4(fragToLight, index), depth).r;
+#endif
+}
+
 float ShadowCalculation(vec3 fragPos, vec3 lightPos, int index)
 {
 	float bias = 0.10;
@@ -39,7 +154,7 @@ float ShadowCalculation(vec3 fragPos, vec3 lightPos, int index)
     float currentDepth = length(fragToLight);
 	
 
-	float cDepth = texture(shadowMaps, vec4(fragToLight , index),(currentDepth - bias)	/ far_plane).r;
+	float cDepth = sampleShadow(fragToLight, (currentDepth - bias) / far_plane, index);
 
     return cDepth;
 }
@@ -69,7 +184,7 @@ float lightVolume(vec3 lightPos, int index,float depth){
 
 		float attenuation = 1.0 / (currentDepthToLight) * (currentDepthToLight);
 		if(attenuation > 0.2){
-			float cDepth = texture(shadowMaps, vec4(posToLight, index),(currentDepthToLight - bias)	/ far_plane).r;
+			float cDepth = sampleShadow(posToLight, (currentDepthToLight - bias) / far_plane, index);
 			strength += ((cDepth / dfp) + cDepth) * attenuation;
 		}
 
@@ -146,6 +261,7 @@ vec3 ImportanceSampleGGX(vec2 Xi, vec3 N, float roughness)
 }  
 
 
+#ifndef volumetricMarch
 void main(){
 	vec3 FragPos = texture(gPosition, TexCoord).rgb;
 	float FDepth = texture(gDepth, TexCoord).r;
@@ -179,6 +295,9 @@ void main(){
 	vec3 dkD = vec3(1.0) - dkS;
 	dkD *= 1.0 - metallic;	
 	float dNdotL = max(dot(N, dL), 0.0);        
+#ifdef shadowAtlas
+	dradiance *= sunShadow(FragPos);
+#endif
 	Lo += (dkD * albedo / PI + dspecular) * dradiance * dNdotL;
 	vec3 rays = vec3(0);
 
@@ -186,15 +305,30 @@ void main(){
 
 
 	//for each light ... add to lo
+#ifdef clusteredLighting
+	// only the lamps whose range reaches the cluster of the pixel
+	uvec2 cluster = clusterLights(FragPos);
+	for(uint c = 0; c < cluster.y; c++){
+		int i = int(LightIndices[cluster.x + c]);
+#else
 	for(int i=0;i<int(LightColors.length());i++){
+#endif
 		
-	    vec3 L = normalize(LightPositions[i] - FragPos);
+	    vec3 L = normalize(LightPositions[i].xyz - FragPos);
 		vec3 H = normalize(V + L);
 	
-		float distance = length(LightPositions[i] - FragPos);
-		float attenuation = 1.0 / (distance * distance);
+		// inverse square falloff that is windowed to reach zero at the range of the lamp
+		float distance = length(LightPositions[i].xyz - FragPos);
+		float window = clamp(1.0 - pow(distance / LightPositions[i].w, 4.0), 0.0, 1.0);
+		float attenuation = window * window / (distance * distance);
 		vec3 radiance = LightColors[i] * attenuation; 
 
+		// spot lamps fade out at the edge of their cone
+		vec4 cone = LightDirections[i];
+		if(cone.w > -1){
+			radiance *= smoothstep(cone.w, mix(cone.w, 1.0, 0.1), dot(-L, cone.xyz));
+		}
+
 		vec3 F0 = vec3(0.04); 
 		F0 = mix(F0, albedo, metallic);
 		vec3 F  = fresnelSchlick(max(dot(H, V), 0.0), F0);
@@ -210,14 +344,16 @@ void main(){
 		vec3 kD = vec3(1.0) - kS;
 		kD *= 1.0 - metallic;	
 
-		float shadow = ShadowCalculation(FragPos,LightPositions[i],i);        
+		float shadow = ShadowCalculation(FragPos,LightPositions[i].xyz,i);        
 		float NdotL = max(dot(N, L), 0.0);  
 		float lr = 0;
 		vec3 LoAdd = (kD * albedo / PI + specular) * radiance * NdotL * shadow;
 
 		if(useBasicVl){
-			lr = lightVolume(LightPositions[i],i,liniarDepth);
+#ifndef volumetricPass
+			lr = lightVolume(LightPositions[i].xyz,i,liniarDepth);
 			rays += LightColors[i] * lr * 0.0005;
+#endif
 			LoAdd *= 3;
 		}else{
 			LoAdd *= 4;
@@ -230,3 +366,52 @@ void main(){
 	outcolor   = am + Lo + rays;  
 	FragColor = vec4(outcolor * 5, 1.0);
 }
+#else
+uniform int frameIndex;
+
+// noise that differs between neighbouring pixels and frames, so the offsets of the samples of a few pixels and frames fill the gaps between the steps
+float interleavedGradientNoise(vec2 pixel)
+{
+	pixel += 5.588238 * float(frameIndex % 64);
+	return fract(52.9829189 * fract(dot(pixel, vec2(0.06711056, 0.00583715))));
+}
+
+// marches the view ray of the pixel at the reduced resolution of EVolumetricPass, rgb is the light scattered towards the camera and a the view depth the ray ends at
+void main(){
+	float depth = texture(gDepth, TexCoord).r;
+	vec4 viewSpace = invProj * vec4(TexCoord * 2 - 1, depth * 2 - 1, 1);
+	viewSpace /= viewSpace.w;
+	vec3 end = (invView * viewSpace).xyz;
+	vec3 dir = normalize(end - viewPos);
+	float stepLength = min(length(end - viewPos), far) / vlSampleCount;
+	float offset = interleavedGradientNoise(gl_FragCoord.xy);
+
+	vec3 scattered = vec3(0);
+	for(int s = 0; s < vlSampleCount; s++){
+		vec3 p = viewPos + dir * (s + offset) * stepLength;
+#ifdef clusteredLighting
+		// the lamps of the cluster the sample is in
+		uvec2 cluster = clusterLights(p);
+		for(uint c = 0; c < cluster.y; c++){
+			int i = int(LightIndices[cluster.x + c]);
+#else
+		for(int i = 0; i < int(LightColors.length()); i++){
+#endif
+			vec3 toLight = LightPositions[i].xyz - p;
+			float distance = length(toLight);
+			float window = clamp(1.0 - pow(distance / LightPositions[i].w, 4.0), 0.0, 1.0);
+			if(window <= 0){
+				continue;
+			}
+			vec3 radiance = LightColors[i] * window * window / max(distance * distance, 0.01);
+			vec4 cone = LightDirections[i];
+			if(cone.w > -1){
+				radiance *= smoothstep(cone.w, mix(cone.w, 1.0, 0.1), dot(-toLight / distance, cone.xyz));
+			}
+			scattered += radiance * ShadowCalculation(p, LightPositions[i].xyz, i);
+		}
+	}
+	scattered *= stepLength * vlDensity;
+	FragColor = vec4(min(scattered, vec3(vlMax)), dot(end - viewPos, -invView[2].xyz));
+}
+#endif
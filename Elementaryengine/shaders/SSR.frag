@@ -24,6 +24,14 @@ layout(std430, binding = 7) buffer UIE
     UIElement uie[];
 };
 
+#ifdef uiTiles
+// for every tile of uiTileSize pixels the number of elements over it and their indices, built by UIBin.comp
+layout(std430, binding = 25) buffer uiTileElementLists 
+{
+    uint UITiles[];
+};
+#endif
+
 uniform sampler2DArray textures;
 
 uniform sampler2D gPosition;
@@ -41,22 +49,6 @@ uniform vec3 viewPos;
 uniform int screenX;
 uniform int screenY;
 
-const float rayStep = 0.1;
-const float minRayStep = 0.1;
-const int maxSteps = 60;
-const float searchDist = 5;
-const int numBinarySearchSteps = 5;
-const float refSpecFallofExp = 3.0;
-
-const float weights[] = {
-        
-    0.023528,	0.033969,	0.038393,	0.033969,	0.023528,
-    0.033969,	0.049045,	0.055432,	0.049045,	0.033969,
-    0.038393,	0.055432,	0.062651,	0.055432,	0.038393,
-    0.033969,	0.049045,	0.055432,	0.049045,	0.033969,
-    0.023528,	0.033969,	0.038393,	0.033969,	0.023528
-};
-
 //http://dev.theomader.com/gaussian-kernel-calculator/
 const float hqweights[] = {
     
@@ -74,87 +66,17 @@ const float hqweights[] = {
 
 };
 
-float getDepth(vec2 pos){
-    return length(texture(gPosition,TexCoord).rgb - viewPos);
-}
-/*
-vec4 RayCast(in vec3 dir, inout vec3 hitCoord, out float dDepth){
-    dir *= rayStep;
-    float depth = 0.0;
-    int steps = 0;
-    vec4 projectedCoord = vec4(0.0);
-
-    for(int i = 0; i < maxSteps; ++i){
-        hitCoord += dir;
-        projectedCoord = proj * view * vec4(hitCoord,1.0);
-        //projectedCoord.xy /= projectedCoord.w;
-        //projectedCoord.xy = projectedCoord.xy * 0.5 + 0.5;
-
-        depth = texture(gDepth, projectedCoord.xy).z * 25;
-        if(depth > 1000.0)
-            continue;
-
-            dDepth = hitCoord.z - depth;
-
-        if((dir.z - dDepth) < 1.2)
-            if(dDepth <= 0){
-                vec4 Result = vec4(projectedCoord.xy,dDepth,1.0);
-                return Result;
-            }
-    }
-    return vec4(-1);
-}
-vec4 RayCast(in vec3 dir, inout vec3 hitCoord, out float dDepth){
-    dir *= rayStep;
-    float depth = 0.0;
-    int steps = 0;
-    vec4 projectedCoord = vec4(0.0);
-    vec4 resCord = vec4(-1);
-    return resCord;
-    for(int i = 0; i < maxSteps; ++i){
-        hitCoord += dir;
-        projectedCoord =  proj * view * vec4(hitCoord,1.0);
-        projectedCoord.z -= 0.1;
-        
-        float visible = texture(gDepth,projectedCoord.xyz).r;
-
-        if(visible > 0.1){
-            resCord = projectedCoord;
-        }else{
-            return resCord;
-        }
-    }
-    
-    return resCord;
-}
-*/
-float linearDepth(float depthSample)
-{
-   return (2 * near) / (far + near - depthSample * (far - near));
-}
-vec4 RayCast(in vec3 dir, inout vec3 hitCoord, out float dDepth){
-    dir = normalize(dir) * rayStep;
-    vec4 projectedCoord = vec4(0);
-    float currentDepth = 0;
-    vec3 lastSuccessPos;
-    for(int i = 0; i < maxSteps; ++i){
-        //hitCoord += dir;
-        projectedCoord = proj * view * vec4(hitCoord,1.0);
-        projectedCoord.xy /= projectedCoord.w;
-        projectedCoord.xy = projectedCoord.xy * 0.5 + 0.5;
-        projectedCoord.z /= 2;
-        float visible = texture(gDepth,projectedCoord.xyz).r;
-        return vec4(visible);
+#ifdef blurPyramid
+// the lit frame blurred once per frame, every level is half the size of the one before and blurred a bit more
+uniform sampler2D blurLevels;
 
-        if(currentDepth > projectedCoord.z){
-            lastSuccessPos = hitCoord;
-        }else{
-            break;
-        }
-    }
-    hitCoord = lastSuccessPos;
-    return vec4(hitCoord,1);
+vec3 Blurr(vec2 pos, float strength){
+    // the old kernel had a sigma of two samples strength pixels apart, level l has a sigma of about 2^(l+2) pixels
+    float level = log2(max(strength, 0.001)) - 1;
+    vec3 blurred = textureLod(blurLevels, pos, max(level, 0)).rgb;
+    return level < 0 ? mix(texture(gColor, pos).rgb, blurred, clamp(strength / 2, 0, 1)) : blurred;
 }
+#else
 vec3 Blurr(vec2 pos, float strength){
     vec3 outColor = vec3(0);
     vec2 pixelsize = vec2( 1.0 / float(screenX), 1.0 / float(screenY));
@@ -179,6 +101,11 @@ vec3 Blurr(vec2 pos, float strength){
     }
     return outColor;
 }
+#endif
+// true if element a is drawn over element b, elements with the same z are drawn in the order of the list
+bool above(int a, int b){
+    return b == -1 || uie[a].z > uie[b].z || (uie[a].z == uie[b].z && a < b);
+}
 vec3 UI(vec3 bgcol){
     int l0 = -1;
         vec2 l0tc = vec2(0);
@@ -190,7 +117,15 @@ vec3 UI(vec3 bgcol){
         vec2 l2tc = vec2(0);
 
 
+#ifdef uiTiles
+    // only the elements over the tile of the pixel
+    ivec2 tile = ivec2(gl_FragCoord.xy) / uiTileSize;
+    uint tileBase = uint(tile.y * ((screenX + uiTileSize - 1) / uiTileSize) + tile.x) * (uiTileElements + 1);
+    for(uint t = 0; t < UITiles[tileBase]; t++){
+        int i = int(UITiles[tileBase + 1 + t]);
+#else
     for(int i=0; i < int(uie.length()); i++){
+#endif
         float px = (uie[i].posisionPercent.x / 100) + (uie[i].positionPixel.x / screenX); 
         float py = (uie[i].posisionPercent.y / 100) + (uie[i].positionPixel.y / screenY); 
         float sx = (uie[i].sizePercent.x / 100) + (uie[i].sizePixel.x / screenX); 
@@ -199,7 +134,7 @@ vec3 UI(vec3 bgcol){
         float piy = (TexCoord.y - py) / sy;
 
         if(pix > 0 && pix < 1 && piy > 0 && piy < 1 ){
-            if(uie[i].z > uie[l0].z){
+            if(above(i, l0)){
                 l2 = l1;
                 l1 = l0;
                 l0 = i;
@@ -208,13 +143,13 @@ vec3 UI(vec3 bgcol){
                 l1tc = l0tc;
                 l0tc = vec2(pix,piy);
 
-            }else if(uie[i].z > uie[l1].z){
+            }else if(above(i, l1)){
                 l2 = l1;
                 l1 = i;
 
                 l2tc = l1tc;
                 l1tc = vec2(pix,piy);
-            }else if(uie[i].z > uie[l2].z){
+            }else if(above(i, l2)){
                 l2 = i;
 
                 l2tc = vec2(pix,piy);
@@ -262,28 +197,10 @@ vec3 UI(vec3 bgcol){
     return oc;
 }
 void main(){
-    float roughness = texture(gMaterial, TexCoord).r;
-    float metallic = texture(gMaterial, TexCoord).g;
-    vec3 viewNormal = vec3(texture(gNormal, TexCoord));
-    vec3 globalPos =  vec3(texture(gPosition, TexCoord));
+    // the reflections are added to the color by the reflection pass
     vec3 color = texture(gColor,TexCoord).rgb;
-
-    //if(roughness < 100.8 && useSSR){
-        float dX = (2 * TexCoord.x ) - 1;
-        float dY = (2 * TexCoord.y ) - 1; 
-        vec4 dir = invView * vec4((invProj * vec4(dX,dY,0.1,1)).xyz,0);
-
-        vec3 hitCoord = globalPos;
-        float dist;
-        vec3 direction = normalize(reflect(normalize(dir.xyz),normalize(viewNormal)));
-        vec4 hitpos = RayCast(direction,hitCoord, dist);
-        vec3 hitcol =  texture(gColor,hitpos.xy).rgb;
-        FragColor = hitpos;
-        //FragColor = vec4(hitcol,1);
-        //color += 0.5 * hitcol;
-    //}
     color = UI(color);
     FragColor = vec4(color,1);
 
     //FragColor = vec4(Blurr(TexCoord,1),0);
-}
+}
\ No newline at end of file
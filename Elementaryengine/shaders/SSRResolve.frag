@@ -0,0 +1,42 @@
+layout (location = 0) out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// the reflections traced this frame and the accumulated ones of the last frames, rgb = color and a = confidence
+uniform sampler2D current;
+uniform sampler2D history;
+// level 0 of the closest depth pyramid, the depth buffer
+uniform sampler2D hiZ;
+uniform mat4 invProj;
+uniform mat4 invView;
+uniform mat4 proj;
+uniform mat4 previousView;
+// false after a resize, when the history holds nothing
+uniform bool historyValid;
+// the part of a new frame in the accumulated reflections
+uniform float blend;
+
+// accumulates the reflections of the last frames, each traced with other tilted normals, at the position the surface was at in the last frame
+void main(){
+	vec4 reflection = texture(current, TexCoord);
+
+	vec4 viewSpace = invProj * vec4(TexCoord * 2 - 1, textureLod(hiZ, TexCoord, 0).r * 2 - 1, 1);
+	vec4 previousClip = proj * previousView * invView * vec4(viewSpace.xyz / viewSpace.w, 1);
+	vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+	if(!historyValid || previousClip.w <= 0 || any(lessThan(previousUV, vec2(0))) || any(greaterThan(previousUV, vec2(1)))){
+		FragColor = reflection;
+		return;
+	}
+
+	// clamp the history to the reflections around the pixel so moved surfaces don't keep old reflections
+	vec4 lowest = reflection;
+	vec4 highest = reflection;
+	for(int y = -1; y <= 1; y++){
+		for(int x = -1; x <= 1; x++){
+			vec4 neighbour = textureOffset(current, TexCoord, ivec2(x, y));
+			lowest = min(lowest, neighbour);
+			highest = max(highest, neighbour);
+		}
+	}
+	FragColor = mix(clamp(texture(history, previousUV), lowest, highest), reflection, blend);
+}
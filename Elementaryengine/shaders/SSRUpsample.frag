@@ -0,0 +1,53 @@
+layout (location = 0) out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// the accumulated reflections at the reduced resolution, rgb = color and a = confidence
+uniform sampler2D reflections;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+uniform sampler2D gMaterial;
+uniform sampler2D gPosition;
+// level 0 of the closest depth pyramid, the depth buffer
+uniform sampler2D hiZ;
+uniform vec3 viewPos;
+uniform float maxRoughness;
+
+float linearDepth(float depth)
+{
+	return (2.0 * near * far) / (far + near - (depth * 2 - 1) * (far - near));
+}
+
+// upsamples the reflections to the full resolution and adds them to the lit frame by blending, weighted by the fresnel of the surface
+void main(){
+	float roughness = texture(gMaterial, TexCoord).r;
+	if(roughness > maxRoughness){
+		discard;
+	}
+	float depth = linearDepth(textureLod(hiZ, TexCoord, 0).r);
+
+	// the four low resolution texels around the pixel, weighted bilinearly and by how close the depth at their centers is
+	vec2 size = vec2(textureSize(reflections, 0));
+	vec2 position = TexCoord * size - 0.5;
+	ivec2 base = ivec2(floor(position));
+	vec2 f = position - vec2(base);
+	vec4 reflection = vec4(0);
+	float weights = 0;
+	for(int i = 0; i < 4; i++){
+		ivec2 offset = ivec2(i & 1, i >> 1);
+		ivec2 texel = clamp(base + offset, ivec2(0), ivec2(size) - 1);
+		float texelDepth = linearDepth(textureLod(hiZ, (vec2(texel) + 0.5) / size, 0).r);
+		vec2 bilinear = mix(1 - f, f, vec2(offset));
+		float weight = bilinear.x * bilinear.y / (0.001 + abs(texelDepth - depth) / depth);
+		reflection += texelFetch(reflections, texel, 0) * weight;
+		weights += weight;
+	}
+	reflection /= max(weights, 1e-5);
+
+	vec3 N = normalize(texture(gNormal, TexCoord).rgb);
+	vec3 V = normalize(viewPos - texture(gPosition, TexCoord).rgb);
+	vec3 F0 = mix(vec3(0.04), pow(texture(gAlbedoSpec, TexCoord).rgb, vec3(0.8)), texture(gMaterial, TexCoord).g);
+	vec3 fresnel = F0 + (1.0 - F0) * pow(1.0 - max(dot(N, V), 0.0), 5.0);
+	float fade = 1 - smoothstep(maxRoughness * 0.5, maxRoughness, roughness);
+	FragColor = vec4(reflection.rgb * fresnel * reflection.a * fade, 1);
+}
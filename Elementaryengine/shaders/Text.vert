@@ -1,10 +1,26 @@
-layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+// one instance per glyph, the vertices are the corners of its quad
+struct GlyphInstance {
+    vec4 rect;  // <vec2 pos, vec2 size> on screen
+    vec4 uv;    // <vec2 corner, vec2 size> in the glyph atlas
+    vec4 color;
+};
+
+layout(std430, binding = 26) buffer glyphInstances
+{
+    GlyphInstance Glyphs[];
+};
+
 out vec2 TexCoords;
+out vec3 TextColor;
 
 uniform mat4 projection;
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
-    TexCoords = vertex.zw;
-}
\ No newline at end of file
+    GlyphInstance glyph = Glyphs[gl_InstanceID];
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    gl_Position = projection * vec4(glyph.rect.xy + corner * glyph.rect.zw, 0.0, 1.0);
+    // the rows of the glyph bitmaps start at the top
+    TexCoords = glyph.uv.xy + vec2(corner.x, 1.0 - corner.y) * glyph.uv.zw;
+    TextColor = glyph.color.rgb;
+}
@@ -0,0 +1,51 @@
+layout (location = 0) out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// the volumetric light marched this frame and the accumulated one of the last frames, rgb = light and a = view depth
+uniform sampler2D current;
+uniform sampler2D history;
+uniform mat4 invProj;
+uniform mat4 invView;
+uniform mat4 proj;
+uniform mat4 previousView;
+// false after a resize, when the history holds nothing
+uniform bool historyValid;
+// the part of a new frame in the accumulated light
+uniform float blend;
+
+// accumulates the light of the last frames, each frame marched with other offsets, at the position the pixel was at in the last frame
+void main(){
+	vec4 light = texture(current, TexCoord);
+
+	// the world position of the end of the ray in the view of the last frame
+	vec4 viewSpace = invProj * vec4(TexCoord * 2 - 1, 1, 1);
+	viewSpace.xyz /= viewSpace.w;
+	vec3 world = (invView * vec4(viewSpace.xyz * (light.a / -viewSpace.z), 1)).xyz;
+	vec4 previousViewSpace = previousView * vec4(world, 1);
+	vec4 previousClip = proj * previousViewSpace;
+	vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+
+	// the history is only used where it saw the same surface, it is disoccluded if its depth differs
+	if(!historyValid || previousClip.w <= 0 || any(lessThan(previousUV, vec2(0))) || any(greaterThan(previousUV, vec2(1)))){
+		FragColor = light;
+		return;
+	}
+	vec4 previous = texture(history, previousUV);
+	if(abs(previous.a + previousViewSpace.z) > 0.1 * light.a){
+		FragColor = light;
+		return;
+	}
+
+	// clamp the history to the light around the pixel so it doesn't trail behind moving lamps
+	vec3 lowest = light.rgb;
+	vec3 highest = light.rgb;
+	for(int y = -1; y <= 1; y++){
+		for(int x = -1; x <= 1; x++){
+			vec3 neighbour = textureOffset(current, TexCoord, ivec2(x, y)).rgb;
+			lowest = min(lowest, neighbour);
+			highest = max(highest, neighbour);
+		}
+	}
+	FragColor = vec4(mix(clamp(previous.rgb, lowest, highest), light.rgb, blend), light.a);
+}
@@ -0,0 +1,32 @@
+layout (location = 0) out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// the accumulated volumetric light at the reduced resolution, rgb = light and a = view depth
+uniform sampler2D volumetrics;
+uniform sampler2D gDepth;
+uniform mat4 invProj;
+
+// upsamples the volumetric light to the full resolution, it is added to the lit frame by blending
+void main(){
+	// the view depth of the pixel
+	vec4 viewSpace = invProj * vec4(TexCoord * 2 - 1, texture(gDepth, TexCoord).r * 2 - 1, 1);
+	float depth = -viewSpace.z / viewSpace.w;
+
+	// the four low resolution texels around the pixel, weighted bilinearly and by how close their depth is so the light doesn't bleed over edges
+	vec2 size = vec2(textureSize(volumetrics, 0));
+	vec2 position = TexCoord * size - 0.5;
+	ivec2 base = ivec2(floor(position));
+	vec2 f = position - vec2(base);
+	vec3 light = vec3(0);
+	float weights = 0;
+	for(int i = 0; i < 4; i++){
+		ivec2 offset = ivec2(i & 1, i >> 1);
+		vec4 texel = texelFetch(volumetrics, clamp(base + offset, ivec2(0), ivec2(size) - 1), 0);
+		vec2 bilinear = mix(1 - f, f, vec2(offset));
+		float weight = bilinear.x * bilinear.y / (0.001 + abs(texel.a - depth) / depth);
+		light += texel.rgb * weight;
+		weights += weight;
+	}
+	FragColor = vec4(light / max(weights, 1e-5), 1);
+}